@@ -0,0 +1,1003 @@
+#! /usr/bin/env python3
+# -----------------------------------------------------------------------------
+# Copyright (c) 2012 Ben Blazak <benblazak.dev@gmail.com>
+# Copyright (c) 2026 agent <agent@local>
+# Released under The MIT License (MIT) (see "license.md")
+# Project located at <https://github.com/benblazak/ergodox-firmware>
+# -----------------------------------------------------------------------------
+
+"""
+Compile a keymap description (in JSON or YAML) into a layout ('.c' and '.h'
+files), and optionally the UI info file (in JSON)
+
+Depends on:
+- the keymap description file
+- the project source code (for the matrix, keycodes, and keyboard functions)
+- (for the UI info file) the project '.map' file (generated by the compiler)
+
+This replaces "gen-ui-info.py", which read the layout matrices out of the old
+keycode/press/release format.
+"""
+
+_KEYMAP_FORMAT_DESCRIPTION = ("""
+{
+    "name": "<string>",              // for the file header
+    "notes": [ "<string>", "..." ],  // (optional) for the file header
+    "copyright": [                   // (optional) for the file header
+        "<year> <name> <email>", "..."
+    ],
+    "leds": {                        // (optional) LED number for each lock
+        "num": "<number>",
+        "caps": "<number>",
+        "scroll": "<number>"
+    },
+    "layers": [
+        {
+            "name": "<string>",
+            "keys": [
+                /*
+                 * One key per spatial position, in the same order as the
+                 * arguments of `KB_MATRIX_LAYER()` in "matrix.h" (without
+                 * the first, 'unused', argument).
+                 *
+                 * Each key is "<action> <keycode>", where
+                 * - <action> is one of the names in `ACTIONS` (below)
+                 * - <keycode> is a short keycode name (e.g. '_A'), a
+                 *   number, or a layer number (for layer actions); it may
+                 *   be left out if it's 0
+                 */
+                "<string>", "..."
+            ]
+        },
+        "..."
+    ]
+}
+""")[1:-1]
+
+_UI_INFO_FORMAT_DESCRIPTION = ("""
+/* ----------------------------------------------------------------------------
+ * Version 0
+ * ----------------------------------------------------------------------------
+ * Hopefully the add-hoc conventions are clear enough...  I didn't feel like
+ * investing the time in making it a real JSON Schema when there aren't many
+ * validators, and the most current completed draft at the moment (draft 3) is
+ * expired...
+ * ----------------------------------------------------------------------------
+ * Please note that in general, fields may be added without changing the
+ * version number, and that programs using this format are not required to fill
+ * (or read) any of the given fields.
+ * ------------------------------------------------------------------------- */
+
+var ui_info = {
+    ".meta-data": {                    // for the JSON file
+        "version": "<number>",
+        "date-generated": "<string>",  // format: RFC 3339
+		"description": "<string>",
+    },
+    "keyboard-functions": {
+        "<(function name)>": {
+            "position": "<number>",  // as given by the .map file
+            "length": "<number>",    // as given by the .map file
+            "comments": {
+                "name": "<string>",  // more user friendly name
+                "description": "<string>",
+                "notes": [
+                    "<string>",
+                    "..."
+                ],
+                "..."
+            }
+        },
+        "..."
+    },
+    "layout-matrices": {
+        "<(matrix name)>": {
+            "position": "<number>",  // as given by the .map file
+            "length": "<number>"     // as given by the .map file
+        },
+        "..."
+    },
+    "mappings": {
+        /* 
+         * The mappings prefixed with 'matrix' have their elements in the same
+         * order as the .hex file (whatever order that is).  The mappings
+         * prefixed with 'physical' will have their elements in an order
+         * corresponding to thier physical position on the keyboard.  You can
+         * convert between the two using the relative positions of the key-ids
+         * in 'physical-positions' and 'matrix-positions'.
+         *
+         * The current order of 'physical' mappings is:
+         * --------------------------------------------
+         * // left hand, spatial positions
+         * 00, 01, 02, 03, 04, 05, 06,
+         * 07, 08, 09, 10, 11, 12, 13,
+         * 14, 15, 16, 17, 18, 19,
+         * 20, 21, 22, 23, 24, 25, 26,
+         * 27, 28, 29, 30, 31,
+         *                     32, 33,
+         *                     34, 35, 36,
+         *                     37, 38, 39,
+
+         * // right hand, spatial positions
+         *     40, 41, 42, 43, 44, 45, 46,
+         *     47, 48, 49, 50, 51, 52, 53,
+         *         54, 55, 56, 57, 58, 59,
+         *     60, 61, 62, 63, 64, 65, 66,
+         *             67, 68, 69, 70, 71,
+         *     72, 73,
+         * 74, 75, 76,
+         * 77, 78, 79,
+         * --------------------------------------------
+         */
+
+        "physical-positions": [  // list of key-ids
+            "<string>", "..."
+        ],
+        "matrix-positions": [    // list of key-ids
+            "<string>", "..."
+        ],
+        "matrix-layout": [
+            [  // begin layer
+                [  // begin key
+                    "<number>",  // keycode
+                    "<string>",  // press function name (ex: 'kbfun_...')
+                    "<string>"   // release function name (ex: 'NULL')
+                ],
+                "..."  // more keys
+            ],
+            "..."  // more layers
+        ]
+    },
+    "miscellaneous": {
+        "git-commit-date": "<string>",  // format: RFC 3339
+        "git-commit-id": "<string>",
+        "number-of-layers": "<number>",
+        "layout-encoding": "<string>",     // 'full' or 'sparse'
+        "layout-flash-bytes": "<number>"
+    }
+}
+""")[1:-1]
+
+# -----------------------------------------------------------------------------
+
+import argparse
+import collections
+import json
+import os
+import re
+import sys
+
+# -----------------------------------------------------------------------------
+
+# action name => (press function, release function)
+ACTIONS = collections.OrderedDict([
+	( 'none',    (None,                                  None) ),
+	( 'prrel',   ('kbfun_press_release',                 'kbfun_press_release') ),
+	( 'trans',   ('kbfun_transparent',                   'kbfun_transparent') ),
+	( 'tog',     ('kbfun_toggle',                        None) ),
+	( 'shprre',  ('kbfun_shift_press_release',           'kbfun_shift_press_release') ),
+	( '2kcap',   ('kbfun_2_keys_capslock_press_release', 'kbfun_2_keys_capslock_press_release') ),
+] + [
+	( 'hold'+str(n), ('kbfun_layer_push_'+str(n), 'kbfun_layer_pop_'+str(n)) )
+	for n in range(1, 11)
+] + [
+	( 'push'+str(n), ('kbfun_layer_push_'+str(n), None) )
+	for n in range(1, 11)
+] + [
+	( 'pop'+str(n),  ('kbfun_layer_pop_'+str(n), None) )
+	for n in range(1, 11)
+] + [
+	( 'punum',   ('kbfun_layer_push_numpad',             None) ),
+	( 'ponum',   ('kbfun_layer_pop_numpad',              None) ),
+	( 'holdnum', ('kbfun_layer_push_numpad',             'kbfun_layer_pop_numpad') ),
+	( 'btldr',   ('kbfun_jump_to_bootloader',            None) ),
+])
+
+# actions whose keycode is the number of a layer they push
+LAYER_ACTIONS = set( name for (name, (press, release)) in ACTIONS.items()
+                     if press and 'layer_push' in press )
+
+# function name => alias (as used in the generated layout), in groups
+ALIAS_GROUPS = [
+	( 'basic', [ ('kbfun_press_release', 'kprrel'),
+	             ('kbfun_toggle',        'ktog'),
+	             ('kbfun_transparent',   'ktrans') ] ),
+	( '--- layer push/pop functions',
+	  [ ('kbfun_layer_push_'+str(n), 'lpush'+str(n)) for n in range(1, 11) ]
+	  + [ ('kbfun_layer_pop_'+str(n), 'lpop'+str(n)) for n in range(1, 11) ] ),
+	( 'device', [ ('kbfun_jump_to_bootloader', 'dbtldr') ] ),
+	( 'special', [ ('kbfun_shift_press_release',           'sshprre'),
+	               ('kbfun_2_keys_capslock_press_release', 's2kcap'),
+	               ('kbfun_layer_push_numpad',             'slpunum'),
+	               ('kbfun_layer_pop_numpad',              'slponum') ] ),
+]
+ALIASES = dict( pair for (group, pairs) in ALIAS_GROUPS for pair in pairs )
+
+# flash used by each encoding (see "default--*matrix-control.h")
+BYTES_PER_WORD = 2
+BYTES_PER_SPARSE_INDEX = 26
+
+# -----------------------------------------------------------------------------
+
+class KeymapError(Exception):
+	pass
+
+class Key():
+	"""One key on one layer: an action name, and a keycode"""
+
+	def __init__(self, action, keycode='0'):
+		self.action = action
+		self.keycode = keycode
+
+	def __eq__(self, other):
+		return (self.action, self.keycode) == (other.action, other.keycode)
+
+	def __hash__(self):
+		return hash((self.action, self.keycode))
+
+	def c(self):
+		return 'K(' + self.action + ',' + self.keycode + ')'
+
+# -----------------------------------------------------------------------------
+
+def parse_matrix_file(matrix_file_path):
+	"""
+	Return the spatial positions (in `KB_MATRIX_LAYER()` argument order, not
+	including the first) and the matrix positions (in row major order) of
+	each key, as 'k##' names ('na' for unused matrix positions)
+	"""
+
+	match = re.search(  # find the whole 'KB_MATRIX_LAYER' macro
+			r'#define\s+KB_MATRIX_LAYER\s*\(([^)]+)\)[^{]*\{\{([^#]+)\}\}',
+			open(matrix_file_path).read() )
+
+	return ( re.findall(r'k..', match.group(1)),
+	         re.findall(r'k..|na', match.group(2)) )
+
+def parse_keycodes(source_code_path):
+	"""Return a dictionary of keycode names (short and long) => values"""
+
+	usage_page = os.path.join(source_code_path, 'lib', 'usb', 'usage-page')
+
+	defines = {}
+	for file_name in ('keyboard.h', 'keyboard--short-names.h'):
+		for (name, value) in re.findall(
+				r'#define\s+(\w+)\s+(\w+)',
+				open(os.path.join(usage_page, file_name)).read() ):
+			defines[name] = value
+
+	def resolve(name, depth=0):
+		value = defines.get(name, name)
+		if re.match(r'^(0x[0-9A-Fa-f]+|[0-9]+)$', value):
+			return int(value, 0)
+		if depth > 8 or value not in defines:
+			return None
+		return resolve(value, depth+1)
+
+	keycodes = {}
+	for name in defines:
+		value = resolve(name)
+		if value is not None and value <= 0xFF:
+			keycodes[name] = value
+	return keycodes
+
+def load_keymap(keymap_file_path):
+	"""Read the keymap description (JSON, or YAML if the name ends that way)"""
+
+	text = open(keymap_file_path).read()
+
+	if re.search(r'\.ya?ml$', keymap_file_path):
+		try:
+			import yaml
+		except ImportError:
+			raise KeymapError("reading YAML needs the 'PyYAML' module")
+		return yaml.safe_load(text)
+
+	return json.loads(text)
+
+def parse_layers(keymap, spatial_positions, keycodes):
+	"""Return the layers of 'keymap' as lists of `Key`s, in spatial order"""
+
+	layers = []
+	for (number, layer) in enumerate(keymap['layers']):
+		keys = layer['keys']
+		if len(keys) != len(spatial_positions):
+			raise KeymapError(
+					"layer {} has {} keys (should have {})".format(
+						number, len(keys), len(spatial_positions) ) )
+
+		parsed = []
+		for (position, key) in zip(spatial_positions, keys):
+			fields = str(key).split()
+			if not 1 <= len(fields) <= 2:
+				raise KeymapError(
+						"layer {}, {}: can't parse '{}'".format(
+							number, position, key ) )
+			if fields[0] not in ACTIONS:
+				raise KeymapError(
+						"layer {}, {}: unknown action '{}'".format(
+							number, position, fields[0] ) )
+			if len(fields) == 2 and fields[1] not in keycodes \
+					and not re.match(r'^(0x[0-9A-Fa-f]+|[0-9]+)$', fields[1]):
+				raise KeymapError(
+						"layer {}, {}: unknown keycode '{}'".format(
+							number, position, fields[1] ) )
+			parsed.append(Key(*fields))
+
+		layers.append(parsed)
+
+	return layers
+
+# -----------------------------------------------------------------------------
+
+def keycode_value(key, keycodes):
+	if key.keycode in keycodes:
+		return keycodes[key.keycode]
+	return int(key.keycode, 0)
+
+def deduplicate_layers(layers, names, keycodes):
+	"""
+	Remove layers that are the same as an earlier layer, and renumber the
+	layer actions that pushed them
+	"""
+
+	keep = []     # old numbers of the layers we keep
+	renumber = {}  # old number => new number
+	for (number, layer) in enumerate(layers):
+		for (new, old) in enumerate(keep):
+			if layers[old] == layer:
+				renumber[number] = new
+				break
+		else:
+			renumber[number] = len(keep)
+			keep.append(number)
+
+	def fix(key):
+		if key.action in LAYER_ACTIONS:
+			old = keycode_value(key, keycodes)
+			if old not in renumber:
+				raise KeymapError(
+						"a '{}' key pushes layer {}, which doesn't exist".format(
+							key.action, old ) )
+			if renumber[old] != old:
+				return Key(key.action, str(renumber[old]))
+		return key
+
+	return ( [ [fix(key) for key in layers[old]] for old in keep ],
+	         [ names[old] for old in keep ],
+	         [ old for old in range(len(layers)) if old not in keep ] )
+
+def resolve_transparency(layers, keycodes, remappable=False):
+	"""
+	Replace transparent keys whose result doesn't depend on the state of the
+	layer stack (for the full encoding only: the sparse encoding keeps them,
+	since they cost nothing there)
+	- On layer 0 there's nothing below, so transparent keys do nothing.
+	- On other layers, if every layer that can be active has either the same
+	  key or a transparent key at a position, transparent keys there are
+	  replaced by that key.  Unless 'remappable' (keys can be remapped at
+	  runtime): then a remap of the key below has to carry up through them,
+	  so they're left as they are.
+	"""
+
+	none = Key('none')
+	layers = [ [ (none if key.action == 'trans' else key)
+	             for key in layers[0] ] ] + [list(l) for l in layers[1:]]
+	if remappable:
+		return layers
+
+	# layers that can be active: 0, and any a layer action pushes
+	active = set([0])
+	for layer in layers:
+		for key in layer:
+			if key.action in LAYER_ACTIONS:
+				active.add(keycode_value(key, keycodes))
+	active = [a for a in sorted(active) if a < len(layers)]
+
+	for position in range(len(layers[0])):
+		below = set( layers[a][position] for a in active
+		             if layers[a][position].action != 'trans' )
+		if len(below) != 1:
+			continue
+		(key,) = below
+		for layer in layers[1:]:
+			if layer[position].action == 'trans':
+				layer[position] = key
+
+	return layers
+
+def sparse_layer(layer):
+	"""Return (fill, overrides) for 'layer', with the most compact fill"""
+
+	fill = collections.Counter(layer).most_common(1)[0][0]
+	return ( fill,
+	         [ (index, key) for (index, key) in enumerate(layer)
+	           if key != fill ] )
+
+def encoding_sizes(full_layers, sparse_layers, matrix_size):
+	"""Return the flash used by each encoding, in bytes"""
+
+	full = len(full_layers) * matrix_size * BYTES_PER_WORD
+	sparse = ( matrix_size * BYTES_PER_WORD
+	           + sum( BYTES_PER_SPARSE_INDEX
+	                  + len(sparse_layer(layer)[1]) * BYTES_PER_WORD
+	                  for layer in sparse_layers[1:] ) )
+	return { 'full': full, 'sparse': sparse }
+
+# -----------------------------------------------------------------------------
+
+def used_actions(layers):
+	"""Return the names of the actions 'layers' use, in table order"""
+
+	used = set(key.action for layer in layers for key in layer)
+	used.add('none')
+	return [name for name in ACTIONS if name in used]
+
+# -----------------------------------------------------------------------------
+
+def c_header(keymap, keymap_file_name, title):
+	lines = [ title ]
+	for note in keymap.get('notes', []):
+		lines += [ '', note ]
+	lines += [ '',
+	           'Generated by "build-scripts/gen-keymap.py" from "'
+	           + keymap_file_name + '".',
+	           'Edit that, and regenerate, instead of editing this file.' ]
+
+	return ( '/* ' + '-'*76 + '\n'
+	         + ''.join( (' * ' + line).rstrip() + '\n' for line in lines )
+	         + ' * ' + '-'*76 + '\n'
+	         + ''.join( ' * Copyright (c) ' + holder + '\n'
+	                    for holder in keymap.get('copyright', []) )
+	         + ' * Released under The MIT License (MIT) (see "license.md")\n'
+	         + ' * Project located at '
+	         + '<https://github.com/benblazak/ergodox-firmware>\n'
+	         + ' * ' + '-'*73 + ' */\n' )
+
+def gen_h_file( keymap, keymap_file_name, guard, layers, encoding,
+                resolved=False ):
+	leds = keymap.get('leds', {'num': 1, 'caps': 2, 'scroll': 3})
+
+	out = c_header( keymap, keymap_file_name,
+	                'ergoDOX : layout : ' + keymap['name'] + ' : exports' ) + '\n\n'
+	out += '#ifndef KEYBOARD__ERGODOX__LAYOUT__' + guard + '_h\n'
+	out += '\t#define KEYBOARD__ERGODOX__LAYOUT__' + guard + '_h\n\n'
+	out += '\t#include "../controller.h"\n\n'
+	out += '\t// ' + '-'*68 + '\n\n'
+	for lock in ('num', 'caps', 'scroll'):
+		if lock not in leds:
+			continue
+		for state in ('on', 'off'):
+			macro = 'kb_led_' + lock + '_' + state + '()'
+			out += ( '\t#define ' + macro.ljust(21) + '_kb_led_'
+			         + str(leds[lock]) + '_' + state + '()\n' )
+	out += '\n\t// ' + '-'*68 + '\n\n'
+	actions = used_actions(layers)
+	layer_actions = sum( 1 << index for (index, name) in enumerate(actions)
+	                     if name in LAYER_ACTIONS )
+	out += '\t#define KB_LAYERS ' + str(len(layers)) + '\n\n'
+	out += ( '\t// the number of actions in `_kb_actions`, and a bitmap of the '
+	         'ones whose\n'
+	         '\t// keycode is a layer number\n' )
+	out += '\t#define KB_ACTIONS        ' + str(len(actions)) + '\n'
+	out += '\t#define KB_LAYER_ACTIONS  0x{:X}ULL\n\n'.format(layer_actions)
+	if resolved:
+		out += ( '\t// transparent keys above layer 0 were replaced by the '
+		         'keys below them, so\n'
+		         '\t// remaps of those keys (at runtime) wouldn\'t carry up '
+		         'through them\n'
+		         '\t#define KB_TRANSPARENCY_RESOLVED  1\n\n' )
+	out += '\t#include "./default--led-control.h"\n'
+	if encoding == 'sparse':
+		out += '\t#include "./default--sparse-matrix-control.h"\n'
+	out += '\t#include "./default--matrix-control.h"\n\n'
+	out += '#endif\n\n'
+	return out
+
+def gen_matrix_layer(title, keys, comma):
+	"""Format one `KB_MATRIX_LAYER()`, lined up like the spatial layout"""
+
+	# (number of keys, indent in keys) for each line of each hand
+	left  = [(7,0), (7,0), (6,0), (7,0), (5,0), (2,5), (3,4), (3,4)]
+	right = [(7,0), (7,0), (6,1), (7,0), (5,2), (2,0), (3,0), (3,0)]
+
+	keys = [key.c() + ',' for key in keys]
+
+	def block(shape, keys):
+		rows = []
+		for (count, indent) in shape:
+			rows.append([None]*indent + keys[:count])
+			keys = keys[count:]
+		widths = [ max( [len(row[c]) for row in rows
+		                 if c < len(row) and row[c]] + [0] )
+		           for c in range(max(len(row) for row in rows)) ]
+		return [ ' '.join( (row[c] or '').ljust(widths[c])
+		                   for c in range(len(row)) ).rstrip()
+		         for row in rows ]
+
+	lines = ( [ '\tKB_MATRIX_LAYER(  // ' + title,
+	            '// unused',
+	            Key('none').c() + ',',
+	            '// left hand' ]
+	          + block(left, keys[:40])
+	          + [ '// right hand' ]
+	          + block(right, keys[40:]) )
+	lines[-1] = lines[-1][:-1] + ' )' + (',' if comma else '')
+	return '\n'.join(lines) + '\n'
+
+def gen_c_file( keymap, keymap_file_name, layers, names, encoding,
+                spatial_positions ):
+	separator = '// ' + '-'*76 + '\n'
+
+	out = c_header( keymap, keymap_file_name,
+	                'ergoDOX layout : ' + keymap['name'] ) + '\n\n'
+	out += ( '#include <stdint.h>\n'
+	         '#include <stddef.h>\n'
+	         '#include <avr/pgmspace.h>\n'
+	         '#include "../../../lib/data-types/misc.h"\n'
+	         '#include "../../../lib/usb/usage-page/keyboard--short-names.h"\n'
+	         '#include "../../../lib/key-functions/public.h"\n'
+	         '#include "../matrix.h"\n'
+	         '#include "../layout.h"\n\n' )
+	out += separator + separator + '\n'
+
+	# aliases
+	out += '// aliases\n'
+	for (group, pairs) in ALIAS_GROUPS:
+		if not group.startswith('---'):
+			out += '\n'
+		out += '// ' + group + '\n'
+		width = max(len(alias) for (function, alias) in pairs)
+		for (function, alias) in pairs:
+			out += ( '#define  ' + alias.ljust(width) + '  &'
+			         + function + '\n' )
+		if group.startswith('---'):
+			out += '// ---\n'
+	out += '\n' + separator + separator + '\n'
+
+	# actions
+	actions = used_actions(layers)
+	out += ( "// actions: what a key does when it's pressed, and when it's "
+	         "released\n"
+	         "// - each key's action word (below) has the index of its "
+	         "action in this table\n"
+	         "//   in the high byte, and its keycode (or layer number) in the "
+	         "low byte\n"
+	         "// - this table is small, so it's kept in RAM, and looking up "
+	         "a key only takes\n"
+	         "//   one read from flash\n\n" )
+	out += 'enum actions {\n'
+	for (index, name) in enumerate(actions):
+		out += '\ta_' + name + ','
+		if index == 0:
+			out += '  // must be first (unused positions are 0)'
+		out += '\n'
+	out += '};\n\n'
+	out += 'const void_funptr_t _kb_actions[][2] = {\n'
+	width = max(len(name) for name in actions) + 2
+	out += '\t' + ' '*(width+5) + '// press    release\n'
+	for name in actions:
+		(press, release) = ( (ALIASES[f] if f else 'NULL')
+		                     for f in ACTIONS[name] )
+		out += ( '\t[' + ('a_'+name).ljust(width) + '] = { '
+		         + (press+',').ljust(8) + ' ' + release.ljust(7) + ' },\n' )
+	out += '};\n\n'
+	out += '#define  K(action, keycode)  KB_ACTION(a_##action, keycode)\n\n'
+	out += separator + separator + '\n'
+
+	# matrices
+	if encoding == 'full':
+		out += ( 'const uint16_t PROGMEM '
+		         '_kb_layout_actions[KB_LAYERS][KB_ROWS][KB_COLUMNS] = {\n\n' )
+		for (number, (layer, name)) in enumerate(zip(layers, names)):
+			out += gen_matrix_layer( 'layer ' + str(number) + ': ' + name,
+			                         layer, True )
+			out += '\n\n' if number < len(layers)-1 else '\n'
+		out += '};\n\n'
+	else:
+		out += 'const uint16_t PROGMEM _kb_layout_base[KB_ROWS][KB_COLUMNS] =\n'
+		out += gen_matrix_layer( 'layer 0: ' + names[0], layers[0], False )
+		out = out[:-1] + ';\n\n'
+		out += separator + '\n'
+		out += ( '// the other layers: the keys each one overrides, by '
+		         'matrix position (see\n'
+		         '// "../matrix.h"); everything else on them is the last '
+		         'argument to\n'
+		         '// `KB_SPARSE_LAYER()` (below)\n\n' )
+		fills = []
+		for (number, layer) in list(enumerate(layers))[1:]:
+			(fill, overrides) = sparse_layer(layer)
+			fills.append(fill)
+			overrides = sorted( (int(spatial_positions[i][1:], 16), key)
+			                    for (i, key) in overrides )
+			out += ( '#define  LAYER_' + str(number) + '(O)  /* layer '
+			         + str(number) + ': ' + names[number] + ' */' )
+			width = max([len(key.c()) for (p, key) in overrides] + [0])
+			for (position, key) in overrides:
+				out += ( ' \\\n\tO( 0x{:02X}, '.format(position)
+				         + key.c().ljust(width) + ' )' )
+			out += '\n\n'
+		for number in range(1, len(layers)):
+			out += 'KB_SPARSE_LAYER_ACTIONS( LAYER_' + str(number) + ' );\n'
+		out += ( '\nconst struct kb_sparse_layer PROGMEM '
+		         '_kb_layout_sparse[KB_LAYERS-1] = {\n' )
+		for (number, fill) in enumerate(fills, 1):
+			out += ( '\tKB_SPARSE_LAYER( LAYER_' + str(number) + ', '
+			         + fill.c() + ' ),\n' )
+		out += '};\n\n'
+
+	return out
+
+# -----------------------------------------------------------------------------
+
+def gen_static(current_date=None, git_commit_date=None, git_commit_id=None):
+	"""Generate static information"""
+
+	return {
+		'.meta-data': {
+			'version': 0,  # the format version number
+			'date-generated': current_date,
+			'description': _UI_INFO_FORMAT_DESCRIPTION,
+		},
+		'miscellaneous': {
+			'git-commit-date': git_commit_date, # should be passed by makefile
+			'git-commit-id': git_commit_id, # should be passed by makefile
+		},
+	}
+
+def parse_mapfile(map_file_path):
+	"""Parse the '.map' file"""
+
+	def parse_keyboard_function(f, line):
+		"""Parse keyboard-functions in the '.map' file"""
+
+		search = re.search(r'(0x\S+)\s+(0x\S+)', next(f))
+		position = int( search.group(1), 16 )
+		length = int( search.group(2), 16 )
+
+		search = re.search(r'0x\S+\s+(\S+)', next(f))
+		name = search.group(1)
+
+		return {
+			'keyboard-functions': {
+				name: {
+					'position': position,
+					'length': length,
+				},
+			},
+		}
+
+	def parse_layout_matrices(f, line):
+		"""Parse layout matrix information in the '.map' file"""
+
+		name = re.search(r'.progmem.data.(_kb_layout\S*)', line).group(1)
+
+		search = re.search(r'(0x\S+)\s+(0x\S+)', next(f))
+		position = int( search.group(1), 16 )
+		length = int( search.group(2), 16 )
+
+		return {
+			'layout-matrices': {
+				name: {
+					'position': position,
+					'length': length,
+				},
+			},
+		}
+
+	# --- parse_mapfile() ---
+
+	# normalize paths
+	map_file_path = os.path.abspath(map_file_path)
+	# check paths
+	if not os.path.exists(map_file_path):
+		raise ValueError("invalid 'map_file_path' given")
+
+	output = {}
+
+	f = open(map_file_path)
+
+	for line in f:
+		if re.search(r'^\s*\.text\.kbfun_', line):
+			dict_merge(output, parse_keyboard_function(f, line))
+		elif re.search(r'^\s*\.progmem\.data.*layout', line):
+			dict_merge(output, parse_layout_matrices(f, line))
+
+	return output
+
+
+def find_keyboard_functions(source_code_path):
+	"""Parse all files in the source directory"""
+
+	def read_comments(f, line):
+		"""
+		Read in properly formatted multi-line comments
+		- Comments must start with '/*' and end with '*/', each on their own
+		  line
+		"""
+		comments = ''
+		while(line.strip() != r'*/'):
+			comments += line[2:].strip()+'\n'
+			line = next(f)
+		return comments
+
+	def parse_comments(comments):
+		"""
+		Parse an INI style comment string
+		- Fields begin with '[field-name]', and continue until the next field,
+		  or the end of the comment
+		- Fields '[name]', '[description]', and '[note]' are treated specially
+		"""
+
+		def add_field(output, field, value):
+			"""Put a field+value pair in 'output', the way we want it, if the
+			pair is valid"""
+
+			value = value.strip()
+
+			if field is not None:
+				if field in ('name', 'description'):
+					if field not in output:
+						output[field] = value
+				else:
+					if field == 'note':
+						field = 'notes'
+
+					if field not in output:
+						output[field] = []
+
+					output[field] += [value]
+
+		# --- parse_comments() ---
+
+		output = {}
+
+		field = None
+		value = None
+		for line in comments.split('\n'):
+			line = line.strip()
+
+			if re.search(r'^\[.*\]$', line):
+				add_field(output, field, value)
+				field = line[1:-1]
+				value = None
+
+			else:
+				if value is None:
+					value = ''
+				if len(value) > 0 and value[-1] == '.':
+					line = ' '+line
+				value += ' '+line
+
+		add_field(output, field, value)
+
+		return output
+
+	def parse_keyboard_function(f, line, comments):
+		"""Parse keyboard-functions in the source code"""
+
+		search = re.search(r'void\s+(kbfun_\S+)\s*\(void\)', line)
+		name = search.group(1)
+
+		return {
+			'keyboard-functions': {
+				name: {
+					'comments': parse_comments(comments),
+				},
+			},
+		}
+
+	# --- find_keyboard_functions() ---
+
+	# normalize paths
+	source_code_path = os.path.abspath(source_code_path)
+	# check paths
+	if not os.path.exists(source_code_path):
+		raise ValueError("invalid 'source_code_path' given")
+
+	output = {}
+
+	for tup in os.walk(source_code_path):
+		for file_name in tup[2]:
+			# normalize paths
+			file_name = os.path.abspath( os.path.join( tup[0], file_name ) )
+
+			# ignore non '.c' files
+			if file_name[-2:] != '.c':
+				continue
+
+			f = open(file_name)
+
+			comments = ''
+			for line in f:
+				if line.strip() == r'/*':
+					comments = read_comments(f, line)
+				elif re.search(r'void\s+kbfun_\S+\s*\(void\)', line):
+					dict_merge(
+							output,
+							parse_keyboard_function(f, line, comments) )
+
+	return output
+
+def dict_merge(a, b):
+	"""
+	Recursively merge two dictionaries
+	- I was looking around for an easy way to do this, and found something
+	  [here]
+	  (http://www.xormedia.com/recursively-merge-dictionaries-in-python.html).
+	  This is pretty close, but i didn't copy it exactly.
+	"""
+
+	if not isinstance(a, dict) or not isinstance(b, dict):
+		return b
+
+	for (key, value) in b.items():
+		if key in a:
+			a[key] = dict_merge(a[key], value)
+		else:
+			a[key] = value
+
+	return a
+
+# -----------------------------------------------------------------------------
+
+def gen_ui_info( args, layers, keycodes, spatial_positions, matrix_positions,
+                 encoding, sizes ):
+	"""Generate the UI info file (see `_UI_INFO_FORMAT_DESCRIPTION`)"""
+
+	output = {}
+	dict_merge( output, gen_static( args.current_date,
+	                                args.git_commit_date,
+	                                args.git_commit_id ) )
+	if args.map_file_path:
+		dict_merge(output, parse_mapfile(args.map_file_path))
+	dict_merge(output, find_keyboard_functions(args.source_code_path))
+
+	# keys in matrix order, as [keycode, press function, release function]
+	matrix_layout = []
+	for layer in layers:
+		by_position = dict(zip(spatial_positions, layer))
+		matrix_layout.append([])
+		for position in matrix_positions:
+			key = by_position.get(position, Key('none'))
+			(press, release) = ( (f if f else 'NULL')
+			                     for f in ACTIONS[key.action] )
+			matrix_layout[-1].append(
+					[keycode_value(key, keycodes), press, release] )
+
+	dict_merge( output, {
+		'mappings': {
+			'physical-positions': spatial_positions,
+			'matrix-positions': matrix_positions,
+			'matrix-layout': matrix_layout,
+		},
+		'miscellaneous': {
+			'number-of-layers': len(layers),
+			'layout-encoding': encoding,
+			'layout-flash-bytes': sizes[encoding],
+		},
+	} )
+
+	return json.dumps(output, sort_keys=True, indent=4)
+
+# -----------------------------------------------------------------------------
+
+def main():
+	arg_parser = argparse.ArgumentParser(
+			description = 'Compile a keymap description into a layout' )
+
+	arg_parser.add_argument(
+			'--keymap-file',
+			help = "the keymap description ('.json', '.yaml', or '.yml')",
+			required = True )
+	arg_parser.add_argument(
+			'--source-code-path',
+			help = "the path to the source code directory",
+			default = 'src' )
+	arg_parser.add_argument(
+			'--matrix-file-path',
+			help = "the path to the matrix file we're using",
+			default = 'src/keyboard/ergodox/matrix.h' )
+	arg_parser.add_argument(
+			'--c-file',
+			help = "where to write the layout '.c' file" )
+	arg_parser.add_argument(
+			'--h-file',
+			help = "where to write the layout '.h' file" )
+	arg_parser.add_argument(
+			'--encoding',
+			help = "how to store the layers (default: whichever is smaller)",
+			choices = ('auto', 'full', 'sparse'),
+			default = 'auto' )
+	arg_parser.add_argument(
+			'--flash-budget',
+			help = "fail if the layout takes more than this many bytes",
+			type = int )
+	arg_parser.add_argument(
+			'--remappable',
+			help = ( "keys can be remapped at runtime (`EEPROM_KEYMAP`), "
+			       + "so leave transparent keys above layer 0 as they are" ),
+			action = 'store_true' )
+	arg_parser.add_argument(
+			'--ui-info-file',
+			help = "where to write the UI info file" )
+	arg_parser.add_argument(
+			'--current-date',
+			help = ( "for the UI info file; should be in the format "
+			       + "rfc-3339 (e.g. 2006-08-07 12:34:56-06:00)" ) )
+	arg_parser.add_argument(
+			'--git-commit-date',
+			help = ( "for the UI info file; should be in the format "
+			       + "rfc-3339 (e.g. 2006-08-07 12:34:56-06:00)" ) )
+	arg_parser.add_argument(
+			'--git-commit-id',
+			help = "for the UI info file; the git commit ID" )
+	arg_parser.add_argument(
+			'--map-file-path',
+			help = "for the UI info file; the path to the '.map' file" )
+
+	args = arg_parser.parse_args(sys.argv[1:])
+
+	keymap_file_name = os.path.basename(args.keymap_file)
+	try:
+		keymap = load_keymap(args.keymap_file)
+		(spatial_positions, matrix_positions) = \
+				parse_matrix_file(args.matrix_file_path)
+		keycodes = parse_keycodes(args.source_code_path)
+		layers = parse_layers(keymap, spatial_positions, keycodes)
+		names = [layer.get('name', '') for layer in keymap['layers']]
+
+		(layers, names, removed) = \
+				deduplicate_layers(layers, names, keycodes)
+		for old in removed:
+			print( "gen-keymap: layer {} is a duplicate; removed".format(old),
+			       file=sys.stderr )
+
+		full_layers = resolve_transparency( layers, keycodes,
+		                                    args.remappable )
+		sizes = encoding_sizes( full_layers, layers,
+		                        len(matrix_positions) )
+
+		encoding = args.encoding
+		if encoding == 'auto':
+			encoding = min(sizes, key=lambda e: sizes[e])
+		if encoding == 'full':
+			layers = full_layers
+
+		print( "gen-keymap: {}: {} layers, {} encoding, {} bytes of flash "
+		       "(full: {}, sparse: {})".format(
+		           keymap_file_name, len(layers), encoding, sizes[encoding],
+		           sizes['full'], sizes['sparse'] ),
+		       file=sys.stderr )
+
+		if args.flash_budget is not None \
+				and sizes[encoding] > args.flash_budget:
+			raise KeymapError(
+					"{} takes {} bytes of flash (budget: {})".format(
+						keymap_file_name, sizes[encoding],
+						args.flash_budget ) )
+
+	except KeymapError as e:
+		print('gen-keymap: error: ' + str(e), file=sys.stderr)
+		sys.exit(1)
+
+	if args.c_file:
+		open(args.c_file, 'w').write(
+				gen_c_file( keymap, keymap_file_name, layers, names, encoding,
+				            spatial_positions ) )
+	if args.h_file:
+		guard = re.sub(r'\W', '_', keymap['name'].upper())
+		open(args.h_file, 'w').write(
+				gen_h_file( keymap, keymap_file_name, guard, layers,
+				            encoding, encoding == 'full'
+				                      and not args.remappable ) )
+	if args.ui_info_file:
+		open(args.ui_info_file, 'w').write(
+				gen_ui_info( args, layers, keycodes, spatial_positions,
+				             matrix_positions, encoding, sizes ) + '\n' )
+
+# -----------------------------------------------------------------------------
+
+if __name__ == '__main__':
+	main()
+
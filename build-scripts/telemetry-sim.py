@@ -0,0 +1,232 @@
+#! /usr/bin/env python3
+# -----------------------------------------------------------------------------
+# Copyright (c) 2026 agent <agent@local>
+# Released under The MIT License (MIT) (see "license.md")
+# Project located at <https://github.com/benblazak/ergodox-firmware>
+# -----------------------------------------------------------------------------
+
+"""
+A stand-in for the keyboard's raw HID interface, for testing "telemetry.py"
+(and anything else that speaks the protocol) without hardware
+
+Requests are answered the way `telemetry_handle()` (in
+"src/lib/telemetry.c") answers them, with made up (but plausible, and
+repeatable) numbers.  Remaps are kept in memory, with the same limit as
+"src/lib/eeprom-keymap.h".
+
+Run on its own, this goes through every command once, as a self test.
+"""
+
+# -----------------------------------------------------------------------------
+
+import random
+import struct
+import sys
+
+# -----------------------------------------------------------------------------
+
+PACKET_SIZE = 32
+VERSION = 1
+
+ROWS = 6
+COLUMNS = 14
+LAYERS = 4
+ACTIONS = 12  # `KB_ACTIONS`, for "qwerty-kinesis-mod"
+LAYER_ACTIONS = 0x2E0  # `KB_LAYER_ACTIONS`, for the same
+SCAN_RATE = 500
+MHZ = 16
+FEATURES = 0b1111  # all of them
+
+STAGES = 3
+BUCKETS = 16 + 1  # including the overflow bucket
+BUCKET_SHIFT = 13
+BUCKETS_PER_REPLY = (PACKET_SIZE - 3 - 3) // 2
+REGIONS = 6
+TASKS = [  # budget, typical cycles
+	(0, 1200), (0, 300), (0, 250), (3000, 400), (500, 150), (6000, 80) ]
+REMAPS = 32
+
+OK, UNKNOWN_COMMAND, BAD_ARGUMENT, DISABLED, FULL, BUSY = range(6)
+
+# -----------------------------------------------------------------------------
+
+class SimulatedKeyboard():
+	def __init__(self, seed=0):
+		self.random = random.Random(seed)
+		self.replies = []
+		self.ms = 0
+		self.remaps = {}  # (layer, row, column): action
+		self.clear(3)
+
+		# a couple of keys down, and one still bouncing
+		self.raw = [0] * ROWS
+		self.pressed = [0] * ROWS
+		self.raw[2] = self.pressed[2] = (1 << 3) | (1 << 10)
+		self.raw[4] = 1 << 6
+
+	def flash_action(self, layer, row, column):
+		# something repeatable: action 1 (press/release), keycode by position
+		return (1 << 8) | (4 + (layer * ROWS * COLUMNS + row * COLUMNS
+		                         + column) % 0x60)
+
+	def action_valid(self, action):
+		# see `kb_action_valid()`
+		index, keycode = action >> 8, action & 0xFF
+		return index < ACTIONS \
+				and (not LAYER_ACTIONS & (1 << index) or keycode < LAYERS)
+
+	def clear(self, what):
+		if what & 1:
+			# most changes within a couple of scans, and a tail
+			self.histograms = [[0] * BUCKETS for s in range(STAGES)]
+			for i in range(500):
+				seen = self.random.expovariate(1 / 900)
+				sent = self.random.uniform(0, 1000) + 60
+				for stage, cycles in enumerate((seen, sent, seen + sent)):
+					bucket = min(int(cycles * MHZ) >> BUCKET_SHIFT, BUCKETS - 1)
+					self.histograms[stage][bucket] += 1
+			self.dropped = 0
+		if what & 2:
+			self.profile = []
+			for region in range(REGIONS):
+				typical = self.random.randint(100, 3000)
+				runs = self.random.randint(1000, 0xFFFF)
+				self.profile.append(
+						(runs, typical * 9 // 10, typical * 3, typical * runs) )
+
+	# -------------------------------------------------------------------------
+
+	def handle(self, request):
+		"""Return the reply to 'request' (see `telemetry_handle()`)"""
+		command, sequence = request[0], request[1]
+		arg = request[2:7]
+		status = OK
+		data = b''
+
+		if command == 0x00:
+			data = struct.pack( '<BBBBHBBBBBB', VERSION, ROWS, COLUMNS, LAYERS,
+			                    SCAN_RATE, MHZ, FEATURES, STAGES, BUCKETS,
+			                    BUCKET_SHIFT, REGIONS )
+		elif command == 0x01:
+			self.ms += self.random.randint(50, 500)
+			data = struct.pack( '<LHHHH', self.ms,
+			                    SCAN_RATE - self.random.randint(0, 1),
+			                    self.random.randint(4, 40), 2, self.dropped )
+		elif command == 0x02:
+			if arg[0] >= len(TASKS):
+				status = BAD_ARGUMENT
+			else:
+				budget, typical = TASKS[arg[0]]
+				runs = self.ms or 1000
+				data = struct.pack( '<HHHHLL', budget, runs & 0xFFFF,
+				                    1 if budget else 0, 3 if budget else 0,
+				                    typical * 4, typical * runs )
+		elif command == 0x03:
+			stage, first = arg[0], arg[1]
+			if stage >= STAGES or first >= BUCKETS:
+				status = BAD_ARGUMENT
+			else:
+				count = min(BUCKETS - first, BUCKETS_PER_REPLY)
+				counts = self.histograms[stage][first:first+count]
+				data = struct.pack( '<BBB{}H'.format(count),
+				                    stage, first, count, *counts )
+		elif command == 0x04:
+			if arg[0] >= REGIONS:
+				status = BAD_ARGUMENT
+			else:
+				data = struct.pack('<HLLL', *self.profile[arg[0]])
+		elif command == 0x05:
+			data = struct.pack( '<{}H'.format(ROWS * 2),
+			                    *(self.raw + self.pressed) )
+		elif command == 0x06:
+			layer, row, column = arg[0], arg[1], arg[2]
+			if layer >= LAYERS or row >= ROWS or column >= COLUMNS:
+				status = BAD_ARGUMENT
+			else:
+				data = struct.pack( '<H', self.remaps.get(
+						(layer, row, column),
+						self.flash_action(layer, row, column) ) )
+		elif command == 0x10:
+			self.clear(arg[0])
+		elif command == 0x11:
+			key = (arg[0], arg[1], arg[2])
+			action = arg[3] | (arg[4] << 8)
+			if arg[0] >= LAYERS or arg[1] >= ROWS or arg[2] >= COLUMNS \
+					or not self.action_valid(action):
+				status = BAD_ARGUMENT
+			elif self.pressed[arg[1]] & (1 << arg[2]):
+				status = BUSY  # (it'd be released with the new action)
+			elif action == self.flash_action(*key):
+				self.remaps.pop(key, None)
+			elif key not in self.remaps and len(self.remaps) == REMAPS:
+				status = FULL
+			else:
+				self.remaps[key] = action
+		elif command == 0x12:
+			self.remaps = {}
+		else:
+			status = UNKNOWN_COMMAND
+
+		return bytes([command, sequence, status]) \
+				+ data.ljust(PACKET_SIZE - 3, b'\x00')
+
+	# -------------------------------------------------------------------------
+	# the same interface as `Hidraw` (in "telemetry.py")
+
+	def write(self, packet):
+		if len(packet) == PACKET_SIZE + 1:
+			packet = packet[1:]  # the report id
+		if len(packet) != PACKET_SIZE:
+			raise ValueError('packets must be {} bytes'.format(PACKET_SIZE))
+		self.replies.append(self.handle(packet))
+
+	def read(self, timeout):
+		return self.replies.pop(0) if self.replies else None
+
+# -----------------------------------------------------------------------------
+
+def main():
+	keyboard = SimulatedKeyboard()
+	failures = 0
+
+	def request(*packet):
+		keyboard.write(bytes(packet).ljust(PACKET_SIZE, b'\x00'))
+		return keyboard.read(0)
+
+	checks = [
+		( 'info',                request(0x00, 1)[2] == OK ),
+		( 'unknown command',     request(0x7F, 2)[2] == UNKNOWN_COMMAND ),
+		( 'sequence echoed',     request(0x01, 0xAB)[1] == 0xAB ),
+		( 'task out of range',   request(0x02, 3, len(TASKS))[2]
+		                         == BAD_ARGUMENT ),
+		( 'histogram in pieces', request(0x03, 4, 0, 0)[5]
+		                         == BUCKETS_PER_REPLY ),
+		( 'keymap set',          request(0x11, 5, 1, 1, 3, 0x2A, 0x01)[2]
+		                         == OK ),
+		( 'keymap get',          request(0x06, 6, 1, 1, 3)[3:5]
+		                         == b'\x2A\x01' ),
+		( 'keymap range',        request(0x11, 7, LAYERS, 0, 0, 0, 0)[2]
+		                         == BAD_ARGUMENT ),
+		( 'keymap bad action',   request(0x11, 7, 0, 0, 0, 0, ACTIONS)[2]
+		                         == BAD_ARGUMENT ),
+		( 'keymap bad layer',    request(0x11, 7, 0, 0, 0, LAYERS, 5)[2]
+		                         == BAD_ARGUMENT ),
+		( 'keymap key pressed',  request(0x11, 7, 0, 2, 3, 0x2A, 0x01)[2]
+		                         == BUSY ),
+	]
+	for row in range(ROWS):
+		for column in range(COLUMNS):
+			request(0x11, 8, 0, row, column, 0, 0)
+	checks.append(( 'keymap full', len(keyboard.remaps) == REMAPS ))
+
+	for name, passed in checks:
+		print('{}: {}'.format(name, 'ok' if passed else 'FAILED'))
+		failures += not passed
+
+	sys.exit(1 if failures else 0)
+
+# -----------------------------------------------------------------------------
+
+if __name__ == '__main__':
+	main()
+
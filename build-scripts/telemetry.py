@@ -0,0 +1,423 @@
+#! /usr/bin/env python3
+# -----------------------------------------------------------------------------
+# Copyright (c) 2026 agent <agent@local>
+# Released under The MIT License (MIT) (see "license.md")
+# Project located at <https://github.com/benblazak/ergodox-firmware>
+# -----------------------------------------------------------------------------
+
+"""
+Talk to the keyboard over its raw HID interface (through Linux hidraw): read
+counters, latency histograms, profiler counts, and the matrix, and remap keys
+
+Depends on:
+- the firmware being compiled with `RAWHID := 1` (see "src/makefile-options")
+- read and write access to the keyboard's '/dev/hidraw*' device
+- (or nothing, with '--simulate'; see "telemetry-sim.py")
+
+The protocol is described in "src/lib/telemetry.h"; the constants here must
+match the ones there.
+"""
+
+# -----------------------------------------------------------------------------
+
+import argparse
+import glob
+import importlib.util
+import json
+import os
+import select
+import struct
+import sys
+
+# -----------------------------------------------------------------------------
+
+VENDOR_ID = 0x1d50
+PRODUCT_ID = 0x6028
+USAGE_PAGE = 0xFFAB
+
+PACKET_SIZE = 32
+VERSION = 1
+
+COMMANDS = {
+	'info':         0x00,
+	'counters':     0x01,
+	'task':         0x02,
+	'histogram':    0x03,
+	'profile':      0x04,
+	'matrix':       0x05,
+	'keymap-get':   0x06,
+	'clear':        0x10,
+	'keymap-set':   0x11,
+	'keymap-clear': 0x12,
+}
+
+STATUS = [
+	'ok',
+	'unknown command',
+	'bad argument',
+	'disabled (not compiled in)',
+	'full',
+	'busy (release the key, and try again)',
+]
+
+FEATURES = ['latency histograms', 'profile', 'eeprom keymap', 'keymap cache']
+
+# in order (see `enum main_tasks` in "src/main.c")
+TASKS = ['scan', 'dispatch', 'report', 'telemetry', 'leds', 'eeprom']
+
+# in order (see "src/lib/latency.h")
+STAGES = ['seen -> dispatched', 'dispatched -> sent', 'seen -> sent']
+
+# in order (see "src/lib/profile.h")
+REGIONS = [ 'teensy scan', 'mcp23018 scan', 'changes', 'dispatch',
+            'usb send', 'leds' ]
+
+# -----------------------------------------------------------------------------
+
+class TelemetryError(Exception):
+	pass
+
+class Hidraw():
+	"""The keyboard's raw HID interface, as a '/dev/hidraw*' device"""
+
+	def __init__(self, path=None):
+		self.path = path or self.find()
+		self.fd = os.open(self.path, os.O_RDWR)
+
+	@staticmethod
+	def find():
+		hid_id = 'HID_ID=0003:{:08X}:{:08X}'.format(VENDOR_ID, PRODUCT_ID)
+		page = bytes([0x06, USAGE_PAGE & 0xFF, USAGE_PAGE >> 8])
+		for device in sorted(glob.glob('/sys/class/hidraw/hidraw*/device')):
+			try:
+				uevent = open(os.path.join(device, 'uevent')).read()
+				descriptor = open(
+						os.path.join(device, 'report_descriptor'), 'rb' ).read()
+			except OSError:
+				continue
+			if hid_id in uevent.splitlines() and descriptor.startswith(page):
+				return '/dev/' + os.path.basename(os.path.dirname(device))
+		raise TelemetryError(
+				"no keyboard with a raw HID interface found "
+				"(is it plugged in, and compiled with RAWHID := 1?)" )
+
+	def write(self, packet):
+		# the first byte is the report id (which we don't use)
+		os.write(self.fd, b'\x00' + packet)
+
+	def read(self, timeout):
+		if not select.select([self.fd], [], [], timeout)[0]:
+			return None
+		return os.read(self.fd, PACKET_SIZE)
+
+class Keyboard():
+	"""Requests and replies (see "src/lib/telemetry.h")"""
+
+	def __init__(self, device, timeout=1.0, retries=3):
+		self.device = device
+		self.timeout = timeout
+		self.retries = retries
+		self.sequence = 0
+
+	def request(self, command, *arguments):
+		self.sequence = (self.sequence + 1) & 0xFF
+		packet = bytes([COMMANDS[command], self.sequence] + list(arguments))
+		packet = packet.ljust(PACKET_SIZE, b'\x00')
+
+		for attempt in range(self.retries):
+			self.device.write(packet)
+			while True:
+				reply = self.device.read(self.timeout)
+				if reply is None:
+					break  # timed out; try again
+				if reply[0] == packet[0] and reply[1] == packet[1]:
+					if reply[2] != 0:
+						raise TelemetryError( "{}: {}".format(
+								command,
+								STATUS[reply[2]] if reply[2] < len(STATUS)
+								else 'status {}'.format(reply[2]) ) )
+					return reply[3:]
+				# otherwise, it's the reply to an earlier request
+		raise TelemetryError(command + ': no reply')
+
+	# -------------------------------------------------------------------------
+
+	def info(self):
+		d = self.request('info')
+		(version, rows, columns, layers, scan_rate, mhz, features, stages,
+		 buckets, bucket_shift, regions) = struct.unpack_from('<BBBBHBBBBBB', d)
+		if version != VERSION:
+			raise TelemetryError(
+					"protocol version {} (expected {})".format(
+						version, VERSION ) )
+		return {
+			'rows': rows,
+			'columns': columns,
+			'layers': layers,
+			'scan-rate': scan_rate,
+			'mhz': mhz,
+			'features': [ f for i, f in enumerate(FEATURES)
+			              if features & (1 << i) ],
+			'stages': stages,
+			'buckets': buckets,
+			'bucket-shift': bucket_shift,
+			'regions': regions,
+		}
+
+	def counters(self):
+		d = self.request('counters')
+		ms, rate, jitter, overruns, dropped = struct.unpack_from('<LHHHH', d)
+		return {
+			'uptime-ms': ms,
+			'scan-rate': rate,
+			'scan-jitter-max-us': jitter,
+			'scan-overruns': overruns,
+			'latency-dropped': dropped,
+		}
+
+	def tasks(self):
+		tasks = {}
+		for i in range(256):
+			try:
+				d = self.request('task', i)
+			except TelemetryError:
+				break
+			budget, runs, overruns, deferrals, max_, total = \
+					struct.unpack_from('<HHHHLL', d)
+			name = TASKS[i] if i < len(TASKS) else 'task-{}'.format(i)
+			tasks[name] = {
+				'budget': budget,
+				'runs': runs,
+				'overruns': overruns,
+				'deferrals': deferrals,
+				'cycles-max': max_,
+				'cycles-mean': total / runs if runs else 0,
+			}
+		return tasks
+
+	def histograms(self, info):
+		histograms = {}
+		for stage in range(info['stages']):
+			counts = []
+			while len(counts) < info['buckets']:
+				d = self.request('histogram', stage, len(counts))
+				_, first, n = struct.unpack_from('<BBB', d)
+				counts += struct.unpack_from('<{}H'.format(n), d, 3)
+			name = STAGES[stage] if stage < len(STAGES) else str(stage)
+			histograms[name] = counts
+		return histograms
+
+	def profile(self, info):
+		regions = {}
+		for region in range(info['regions']):
+			runs, min_, max_, total = \
+					struct.unpack_from('<HLLL', self.request('profile', region))
+			name = REGIONS[region] if region < len(REGIONS) else str(region)
+			regions[name] = {
+				'runs': runs,
+				'cycles-min': min_ if runs else 0,
+				'cycles-max': max_,
+				'cycles-mean': total / runs if runs else 0,
+			}
+		return regions
+
+	def matrix(self, info):
+		d = self.request('matrix')
+		rows = info['rows']
+		values = struct.unpack_from('<{}H'.format(rows * 2), d)
+		return {'raw': list(values[:rows]), 'pressed': list(values[rows:])}
+
+	def keymap_get(self, layer, row, column):
+		d = self.request('keymap-get', layer, row, column)
+		return struct.unpack_from('<H', d)[0]
+
+	def keymap_set(self, layer, row, column, action):
+		self.request( 'keymap-set', layer, row, column,
+		              action & 0xFF, action >> 8 )
+
+# -----------------------------------------------------------------------------
+
+def bucket_us(bucket, info):
+	"""The upper edge of histogram bucket 'bucket', in microseconds"""
+	return ((bucket + 1) << info['bucket-shift']) / info['mhz']
+
+def percentile_us(counts, percent, info):
+	"""The bucket edge that 'percent' of the counts are at or below, in
+	microseconds (or `None` for the overflow bucket, or no counts)"""
+	total = sum(counts)
+	if not total:
+		return None
+	running = 0
+	for bucket, count in enumerate(counts):
+		running += count
+		if running * 100 >= total * percent:
+			if bucket == len(counts) - 1:
+				return None
+			return bucket_us(bucket, info)
+
+def print_histograms(histograms, info):
+	for name, counts in histograms.items():
+		print('{} ({} changes):'.format(name, sum(counts)))
+		for bucket, count in enumerate(counts):
+			if bucket == len(counts) - 1:
+				edge = '      longer'
+			else:
+				edge = '< {:7.0f} us'.format(bucket_us(bucket, info))
+			print('  {}  {:5}'.format(edge, count))
+
+def print_matrix(matrix, info):
+	for row in range(info['rows']):
+		print(' '.join(
+			( 'X' if matrix['pressed'][row] >> column & 1 else
+			  'x' if matrix['raw'][row] >> column & 1 else '.' )
+			for column in range(info['columns']) ))
+
+def number(string):
+	return int(string, 0)
+
+# -----------------------------------------------------------------------------
+
+def main():
+	arg_parser = argparse.ArgumentParser(
+			description = "Read diagnostics from, and remap keys on, the "
+			              "keyboard, over its raw HID interface" )
+
+	arg_parser.add_argument(
+			'--device',
+			help = "the hidraw device (default: look for the keyboard)" )
+	arg_parser.add_argument(
+			'--simulate', action = 'store_true',
+			help = "talk to a simulated keyboard instead "
+			       "(see 'telemetry-sim.py')" )
+	arg_parser.add_argument(
+			'--json', action = 'store_true',
+			help = "print results as JSON" )
+
+	commands = arg_parser.add_subparsers(dest = 'command')
+
+	commands.add_parser('info', help = "firmware configuration")
+	commands.add_parser('counters', help = "scan timer counters")
+	commands.add_parser('tasks', help = "task scheduler accounting")
+	latency = commands.add_parser(
+			'latency', help = "key latency histograms" )
+	latency.add_argument(
+			'--percentile', type = float, default = 99,
+			help = "percentile to check against '--limit-us' (default: 99)" )
+	latency.add_argument(
+			'--limit-us', type = float,
+			help = "exit with an error if end to end latency, at the given "
+			       "percentile, is over this" )
+	commands.add_parser('profile', help = "cycle profiler counts")
+	commands.add_parser('matrix', help = "the key matrix (X: pressed, "
+	                                     "x: read but not debounced yet)")
+	commands.add_parser('dump', help = "everything (as JSON)")
+	clear = commands.add_parser(
+			'clear', help = "start the histograms and profiler over" )
+	clear.add_argument(
+			'what', nargs = '?', default = 'all',
+			choices = ['latency', 'profile', 'all'] )
+	keymap_get = commands.add_parser(
+			'keymap-get', help = "read a key's action word" )
+	keymap_set = commands.add_parser(
+			'keymap-set', help = "remap a key (kept in the EEPROM)" )
+	for p in (keymap_get, keymap_set):
+		p.add_argument('layer', type = number)
+		p.add_argument('row', type = number)
+		p.add_argument('column', type = number)
+	keymap_set.add_argument(
+			'action', type = number,
+			help = "the action word: (action index << 8) | keycode" )
+	commands.add_parser('keymap-clear', help = "undo all remaps")
+
+	args = arg_parser.parse_args(sys.argv[1:])
+	if not args.command:
+		arg_parser.error('a command is required')
+
+	exit_status = 0
+
+	try:
+		if args.simulate:
+			spec = importlib.util.spec_from_file_location(
+					'telemetry_sim',
+					os.path.join(
+						os.path.dirname(os.path.abspath(__file__)),
+						'telemetry-sim.py' ) )
+			telemetry_sim = importlib.util.module_from_spec(spec)
+			spec.loader.exec_module(telemetry_sim)
+			device = telemetry_sim.SimulatedKeyboard()
+		else:
+			device = Hidraw(args.device)
+
+		keyboard = Keyboard(device)
+		info = keyboard.info()
+		result = None
+
+		if args.command == 'info':
+			result = info
+		elif args.command == 'counters':
+			result = keyboard.counters()
+		elif args.command == 'tasks':
+			result = keyboard.tasks()
+		elif args.command == 'latency':
+			result = keyboard.histograms(info)
+			if args.limit_us is not None:
+				end_to_end = percentile_us(
+						result[STAGES[-1]], args.percentile, info )
+				if end_to_end is None or end_to_end > args.limit_us:
+					print( "telemetry: latency at p{:g} is over {:g} us".format(
+					           args.percentile, args.limit_us ),
+					       file=sys.stderr )
+					exit_status = 1
+			if not args.json:
+				print_histograms(result, info)
+				result = None
+		elif args.command == 'profile':
+			result = keyboard.profile(info)
+		elif args.command == 'matrix':
+			result = keyboard.matrix(info)
+			if not args.json:
+				print_matrix(result, info)
+				result = None
+		elif args.command == 'dump':
+			args.json = True
+			result = {
+				'info': info,
+				'counters': keyboard.counters(),
+				'tasks': keyboard.tasks(),
+				'matrix': keyboard.matrix(info),
+			}
+			if 'latency histograms' in info['features']:
+				result['latency'] = keyboard.histograms(info)
+			if 'profile' in info['features']:
+				result['profile'] = keyboard.profile(info)
+		elif args.command == 'clear':
+			keyboard.request(
+					'clear', {'latency': 1, 'profile': 2, 'all': 3}[args.what] )
+		elif args.command == 'keymap-get':
+			result = '0x{:04x}'.format(
+					keyboard.keymap_get(args.layer, args.row, args.column) )
+		elif args.command == 'keymap-set':
+			keyboard.keymap_set(args.layer, args.row, args.column, args.action)
+		elif args.command == 'keymap-clear':
+			keyboard.request('keymap-clear')
+
+	except (TelemetryError, OSError) as e:
+		print('telemetry: error: ' + str(e), file=sys.stderr)
+		sys.exit(1)
+
+	if result is not None:
+		if args.json:
+			print(json.dumps(result, indent=4))
+		elif isinstance(result, dict):
+			for name, value in result.items():
+				print('{}: {}'.format(name, value))
+		else:
+			print(result)
+
+	sys.exit(exit_status)
+
+# -----------------------------------------------------------------------------
+
+if __name__ == '__main__':
+	main()
+
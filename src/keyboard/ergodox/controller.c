@@ -9,12 +9,40 @@
 
 #include <stdbool.h>
 #include <stdint.h>
+#include "../../lib/latency.h"
+#include "../../lib/profile.h"
+#include "../../lib/time.h"
 #include "./matrix.h"
+#include "./options.h"
 #include "./controller/mcp23018--functions.h"
 #include "./controller/teensy-2-0--functions.h"
 
 // ----------------------------------------------------------------------------
 
+// check options
+#if  CONTROLLER__PIPELINED_SCAN \
+ && !(TEENSY__DRIVE_COLUMNS && MCP23018__DRIVE_COLUMNS)
+	#error "See 'CONTROLLER__PIPELINED_SCAN' in 'options.h'"
+#endif
+
+/*
+ * How long a full scan (with keys down on both halves) takes, in μs
+ * - Modelled, not measured: 895 μs of I2C traffic for our columns (from the
+ *   model in "../../test/mcp23018.c"), plus about 170 μs for the ~45 TWI
+ *   interrupts (~60 cycles each; the bus waits while they run).  The rest of
+ *   the main loop (debouncing, key functions, USB) comes on top of that.
+ * - To measure it, build with `PROFILE := 1`, and add up the "cycles-max" of
+ *   each region from "build-scripts/telemetry.py profile" (the first two are
+ *   the scan).  "telemetry.py counters" shows whether scans are overrunning.
+ */
+#define  FULL_SCAN_US  1070
+
+#if 1000000UL / (MAKEFILE_SCAN_RATE) < FULL_SCAN_US
+	#warning "SCAN_RATE is faster than a full scan; scans will overrun while keys are down (see 'FULL_SCAN_US' in 'controller.c')"
+#endif
+
+// ----------------------------------------------------------------------------
+
 /* returns
  * - success: 0
  * - error: number of the function that failed
@@ -28,16 +56,111 @@ uint8_t kb_init(void) {
 	return 0;  // success
 }
 
+#if CONTROLLER__IDLE_PROBE
+/*
+ * Whether any key on each half was down after the last scan
+ * - If not, that half of the matrix is all 0, and only needs to be probed
+ */
+static bool _teensy_down   = true;
+static bool _mcp23018_down = true;
+
+static bool _any_down(uint16_t matrix[KB_ROWS], uint16_t mask) {
+	uint16_t any = 0;
+
+	for (uint8_t row=0; row<=5; row++)
+		any |= matrix[row];
+
+	return any & mask;
+}
+#endif
+
 /* returns
  * - success: 0
  * - error: number of the function that failed
  */
-uint8_t kb_update_matrix(bool matrix[KB_ROWS][KB_COLUMNS]) {
-	if (teensy_update_matrix(matrix))
-		return 1;
-	if (mcp23018_update_matrix(matrix))
-		return 2;
+uint8_t kb_update_matrix(uint16_t matrix[KB_ROWS]) {
+	uint8_t ret = 0;
 
-	return 0;  // success
+	#if MAKEFILE_LATENCY_HISTOGRAMS
+		// when this scan started, and what the last one read
+		uint32_t start = time_cycles();
+		uint16_t last[KB_ROWS];
+		for (uint8_t row=0; row<KB_ROWS; row++)
+			last[row] = matrix[row];
+	#endif
+
+	// the MCP23018 half is everything that isn't the Teensy half
+	PROFILE_DECLARE(TEENSY_SCAN);
+	PROFILE_BEGIN(MCP23018_SCAN);
+
+	// whether to do a full scan of each half
+	bool teensy   = true;
+	bool mcp23018 = true;
+
+	#if CONTROLLER__IDLE_PROBE
+		PROFILE_START(TEENSY_SCAN);
+		if (!_teensy_down)
+			teensy = teensy_any_key_down();
+		PROFILE_STOP(TEENSY_SCAN);
+		if (!_mcp23018_down && mcp23018_any_key_down(matrix, &mcp23018))
+			ret = 2;
+	#endif
+
+	#if CONTROLLER__PIPELINED_SCAN
+		// whether the MCP23018 is still responding during this scan
+		bool responding = mcp23018 && !mcp23018_update_matrix_begin(matrix);
+
+		for (uint8_t col=0; col<=6; col++) {
+			if (responding)
+				mcp23018_update_column_queue(col);
+
+			// while the I2C bytes are on the bus
+			PROFILE_START(TEENSY_SCAN);
+			if (teensy)
+				teensy_update_column(matrix, 0x7+col);
+			PROFILE_STOP(TEENSY_SCAN);
+
+			if (responding)
+				responding = !mcp23018_update_column_finish(matrix, col);
+		}
+
+		if (responding)
+			responding = !mcp23018_update_matrix_end();
+
+		if (mcp23018 && !responding)
+			ret = 2;
+	#else
+		PROFILE_START(TEENSY_SCAN);
+		if (teensy && teensy_update_matrix(matrix))
+			ret = 1;
+		PROFILE_STOP(TEENSY_SCAN);
+		if (mcp23018 && mcp23018_update_matrix(matrix))
+			ret = 2;
+	#endif
+
+	#if CONTROLLER__IDLE_PROBE
+		PROFILE_START(TEENSY_SCAN);
+		if (teensy)
+			_teensy_down = _any_down(matrix, 0b0011111110000000);
+		PROFILE_STOP(TEENSY_SCAN);
+		if (mcp23018)
+			_mcp23018_down = _any_down(matrix, 0b0000000001111111);
+	#endif
+
+	PROFILE_STOP(MCP23018_SCAN);
+	PROFILE_EXCLUDE(MCP23018_SCAN, TEENSY_SCAN);
+	PROFILE_RECORD(MCP23018_SCAN);
+	PROFILE_RECORD(TEENSY_SCAN);
+
+	#if MAKEFILE_LATENCY_HISTOGRAMS
+		for (uint8_t row=0; row<KB_ROWS; row++) {
+			if (matrix[row] != last[row]) {
+				latency_seen(start);
+				break;
+			}
+		}
+	#endif
+
+	return ret;
 }
 
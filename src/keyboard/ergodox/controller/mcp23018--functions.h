@@ -21,7 +21,18 @@
 	// --------------------------------------------------------------------
 
 	uint8_t mcp23018_init(void);
-	uint8_t mcp23018_update_matrix( bool matrix[KB_ROWS][KB_COLUMNS] );
+	uint8_t mcp23018_update_matrix( uint16_t matrix[KB_ROWS] );
+
+	// pipelined scanning (see "mcp23018.c")
+	uint8_t mcp23018_update_matrix_begin  ( uint16_t matrix[KB_ROWS] );
+	void    mcp23018_update_column_queue  ( uint8_t col );
+	uint8_t mcp23018_update_column_finish ( uint16_t matrix[KB_ROWS],
+	                                        uint8_t col );
+	uint8_t mcp23018_update_matrix_end    ( void );
+
+	// idle probe (see "../options.h")
+	uint8_t mcp23018_any_key_down( uint16_t matrix[KB_ROWS],
+	                               bool * down );
 
 #endif
 
@@ -28,6 +28,7 @@
 // register addresses (see "mcp23018.md")
 #define IODIRA 0x00  // i/o direction register
 #define IODIRB 0x01
+#define IOCON  0x0A  // configuration register
 #define GPPUA  0x0C  // GPIO pull-up resistor register
 #define GPPUB  0x0D
 #define GPIOA  0x12  // general purpose i/o port register (write modifies OLAT)
@@ -39,6 +40,46 @@
 #define TWI_ADDR_WRITE ( (MCP23018_TWI_ADDRESS<<1) | TW_WRITE )
 #define TWI_ADDR_READ  ( (MCP23018_TWI_ADDRESS<<1) | TW_READ  )
 
+// hot-plug
+#define REPROBE_SCANS \
+	( (MCP23018__REPROBE_INTERVAL) * 1UL * (MAKEFILE_SCAN_RATE) / 1000 )
+
+#if REPROBE_SCANS < 1 || REPROBE_SCANS > 0xFFFF
+	#error "See 'MCP23018__REPROBE_INTERVAL' in 'options.h'"
+#endif
+
+// ----------------------------------------------------------------------------
+
+/*
+ * hot-plug state
+ * - The expander is initialized once, when it's first seen.  After that,
+ *   we only watch for it to stop ACKing its address during a scan.  While
+ *   it's detached, we try to initialize it again every
+ *   `MCP23018__REPROBE_INTERVAL` ms, instead of on every scan.
+ */
+static bool     _attached;
+static uint16_t _reprobe_countdown;  // in scans
+
+#if CONTROLLER__PIPELINED_SCAN
+	// transactions for `mcp23018_update_column_*()`
+	// - `_column` writes GPIOA, then (after a repeated start) reads GPIOB
+	static uint8_t _column_data[2] = { GPIOA, 0xFF };
+	static uint8_t _rows_data;
+
+	static struct twi_transaction _column = {
+		.address      = MCP23018_TWI_ADDRESS,
+		.write_data   = _column_data,
+		.write_length = 2,
+		.read_data    = &_rows_data,
+		.read_length  = 1,
+	};
+	static struct twi_transaction _release = {
+		.address      = MCP23018_TWI_ADDRESS,
+		.write_data   = _column_data,
+		.write_length = 2,
+	};
+#endif
+
 // ----------------------------------------------------------------------------
 
 /* returns:
@@ -52,6 +93,20 @@
 uint8_t mcp23018_init(void) {
 	uint8_t ret;
 
+	// set configuration
+	// - BANK   = 0 : register pairs (A, B) are at consecutive addresses
+	// - SEQOP  = 1 : the address pointer toggles between the registers of a
+	//                pair (e.g. GPIOA <-> GPIOB), instead of incrementing
+	//   - so a scan can write the driving port, then (after a repeated
+	//     start) read the other port, without sending another register
+	//     address
+	twi_start();
+	ret = twi_send(TWI_ADDR_WRITE);
+	if (ret) goto out;  // make sure we got an ACK
+	twi_send(IOCON);
+	twi_send(0b00100000);  // IOCON
+	twi_stop();
+
 	// set pin direction
 	// - unused  : input  : 1
 	// - input   : input  : 1
@@ -99,67 +154,105 @@ uint8_t mcp23018_init(void) {
 
 out:
 	twi_stop();
+	_attached = !ret;
 	return ret;
 }
 
-/* returns:
- * - success: 0
- * - failure: twi status code
- */
+// ----------------------------------------------------------------------------
+
 #if KB_ROWS != 6 || KB_COLUMNS != 14
 	#error "Expecting different keyboard dimensions"
 #endif
-uint8_t mcp23018_update_matrix(bool matrix[KB_ROWS][KB_COLUMNS]) {
-	uint8_t ret, data;
 
-	// initialize things, just to make sure
-	// - it's not appreciably faster to skip this, and it takes care of the
-	//   case when the i/o expander isn't plugged in during the first
-	//   init()
-	ret = mcp23018_init();
+/*
+ * Clear our part of the matrix
+ */
+static void _clear(uint16_t matrix[KB_ROWS]) {
+	for (uint8_t row=0; row<=5; row++)
+		matrix[row] &= ~0b0000000001111111;  // cols 0..6
+}
 
-	// if there was an error
-	if (ret) {
-		// clear our part of the matrix
-		for (uint8_t row=0; row<=5; row++)
-			for (uint8_t col=0; col<=6; col++)
-				matrix[row][col] = 0;
+/*
+ * Make sure the expander is initialized before a scan
+ * - If it's detached, only try to reinitialize it once in a while
+ *
+ * Returns
+ * - success: 0
+ * - failure: twi status code (or 1, if we're waiting to reprobe)
+ */
+static uint8_t _probe(void) {
+	uint8_t ret;
 
-		return ret;
+	if (_attached)
+		return 0;
+
+	if (_reprobe_countdown) {
+		_reprobe_countdown--;
+		return 1;
 	}
 
+	ret = mcp23018_init();
+	if (ret)
+		_reprobe_countdown = REPROBE_SCANS;
+
+	return ret;
+}
+
+/*
+ * Note that the expander stopped responding in the middle of a scan
+ */
+static void _detach(void) {
+	_attached = false;
+	_reprobe_countdown = REPROBE_SCANS;
+}
+
+// ----------------------------------------------------------------------------
+
+/* returns:
+ * - success: 0
+ * - failure: twi status code (or 1, if we're waiting to reprobe)
+ */
+uint8_t mcp23018_update_matrix(uint16_t matrix[KB_ROWS]) {
+	uint8_t ret, data;
+
+	ret = _probe();
+	if (ret)
+		goto clear;
+
 
 	// --------------------------------------------------------------------
 	// update our part of the matrix
+	// - the whole sweep is one transaction: for each row (or column), write
+	//   the driving port, then use a repeated start to read the other port
+	//   (see "IOCON" in `mcp23018_init()`)
+	// - only the address bytes are checked: a missing ACK there means the
+	//   expander was unplugged
 
 	#if MCP23018__DRIVE_ROWS
 		for (uint8_t row=0; row<=5; row++) {
 			// set active row low  : 0
 			// set other rows hi-Z : 1
 			twi_start();
-			twi_send(TWI_ADDR_WRITE);
+			ret = twi_send(TWI_ADDR_WRITE);
+			if (ret) goto out;
 			twi_send(GPIOB);
 			twi_send( 0xFF & ~(1<<(5-row)) );
-			twi_stop();
 
 			// read column data
 			twi_start();
-			twi_send(TWI_ADDR_WRITE);
-			twi_send(GPIOA);
-			twi_start();
-			twi_send(TWI_ADDR_READ);
-			twi_read(&data);
-			twi_stop();
+			ret = twi_send(TWI_ADDR_READ);
+			if (ret) goto out;
+			twi_read_last(&data);
 
-			// update matrix
-			for (uint8_t col=0; col<=6; col++) {
-				matrix[row][col] = !( data & (1<<col) );
-			}
+			// update matrix (the whole row at once)
+			matrix[row] = ( matrix[row] & ~0b0000000001111111 )
+			            | ( ~data       &  0b0000000001111111 );
 		}
 
 		// set all rows hi-Z : 1
 		twi_start();
-		twi_send(TWI_ADDR_WRITE);
+		ret = twi_send(TWI_ADDR_WRITE);
+		if (ret) goto out;
 		twi_send(GPIOB);
 		twi_send(0xFF);
 		twi_stop();
@@ -169,29 +262,26 @@ uint8_t mcp23018_update_matrix(bool matrix[KB_ROWS][KB_COLUMNS]) {
 			// set active column low  : 0
 			// set other columns hi-Z : 1
 			twi_start();
-			twi_send(TWI_ADDR_WRITE);
+			ret = twi_send(TWI_ADDR_WRITE);
+			if (ret) goto out;
 			twi_send(GPIOA);
 			twi_send( 0xFF & ~(1<<col) );
-			twi_stop();
 
 			// read row data
 			twi_start();
-			twi_send(TWI_ADDR_WRITE);
-			twi_send(GPIOB);
-			twi_start();
-			twi_send(TWI_ADDR_READ);
-			twi_read(&data);
-			twi_stop();
+			ret = twi_send(TWI_ADDR_READ);
+			if (ret) goto out;
+			twi_read_last(&data);
 
 			// update matrix
-			for (uint8_t row=0; row<=5; row++) {
-				matrix[row][col] = !( data & (1<<(5-row)) );
-			}
+			for (uint8_t row=0; row<=5; row++)
+				KB_MATRIX_SET(matrix, row, col, !( data & (1<<(5-row)) ));
 		}
 
 		// set all columns hi-Z : 1
 		twi_start();
-		twi_send(TWI_ADDR_WRITE);
+		ret = twi_send(TWI_ADDR_WRITE);
+		if (ret) goto out;
 		twi_send(GPIOA);
 		twi_send(0xFF);
 		twi_stop();
@@ -201,6 +291,204 @@ uint8_t mcp23018_update_matrix(bool matrix[KB_ROWS][KB_COLUMNS]) {
 	// /update our part of the matrix
 	// --------------------------------------------------------------------
 
-	return ret;  // success
+	return 0;  // success
+
+out:
+	// the expander stopped responding
+	twi_stop();
+	_detach();
+
+clear:
+	_clear(matrix);
+	return ret;
 }
 
+
+/* ----------------------------------------------------------------------------
+ * pipelined scanning
+ *
+ * For use by `kb_update_matrix()` (see "../controller.c"), which samples
+ * Teensy columns while each of our columns is being read over I2C.
+ *
+ * Usage
+ * - `mcp23018_update_matrix_begin()`
+ * - for each column (0..6), if `begin()` succeeded
+ *   - `mcp23018_update_column_queue()`
+ *   - (do something else)
+ *   - `mcp23018_update_column_finish()`
+ * - `mcp23018_update_matrix_end()`
+ *
+ * Any failure leaves our part of the matrix cleared; the remaining calls for
+ * that scan are then skipped by the caller.
+ * ------------------------------------------------------------------------- */
+#if CONTROLLER__PIPELINED_SCAN
+
+/*
+ * Queue 'transaction', or, if the queue is full, wait for the bus to go idle
+ * and do it with the blocking functions instead
+ * - Either way, `twi_wait()` then returns its status (and its data is read).
+ *   Our transactions have no callback, so that isn't called.
+ */
+static void _queue(struct twi_transaction * transaction) {
+	uint8_t ret;
+
+	if (!twi_queue(transaction))
+		return;
+
+	while (twi_busy());
+	while (TWCR & (1<<TWSTO));  // wait for the last (idle) stop to finish
+
+	twi_start();
+	ret = twi_send( (transaction->address<<1) | TW_WRITE );
+	if (ret) goto out;
+	for (uint8_t i=0; i<transaction->write_length; i++)
+		twi_send(transaction->write_data[i]);
+
+	if (transaction->read_length) {
+		twi_start();
+		ret = twi_send( (transaction->address<<1) | TW_READ );
+		if (ret) goto out;
+		for (uint8_t i=0; i+1<transaction->read_length; i++)
+			twi_read(&transaction->read_data[i]);
+		twi_read_last(&transaction->read_data[transaction->read_length-1]);
+	}
+
+out:
+	twi_stop();
+	transaction->status = ret;
+}
+
+/* returns:
+ * - success: 0
+ * - failure: twi status code (or 1, if we're waiting to reprobe)
+ */
+uint8_t mcp23018_update_matrix_begin(uint16_t matrix[KB_ROWS]) {
+	uint8_t ret = _probe();
+
+	if (ret)
+		_clear(matrix);
+
+	return ret;
+}
+
+/*
+ * Start setting the given column low (and the others hi-Z), and reading
+ * the rows, in one transaction
+ * - If the TWI queue is full, this waits for it, and does the transaction
+ *   before returning (see `_queue()`)
+ */
+void mcp23018_update_column_queue(uint8_t col) {
+	_column_data[1] = 0xFF & ~(1<<col);
+	_queue(&_column);
+}
+
+/* returns:
+ * - success: 0
+ * - failure: twi status code
+ */
+uint8_t mcp23018_update_column_finish( uint16_t matrix[KB_ROWS],
+                                       uint8_t col ) {
+	uint8_t ret;
+
+	ret = twi_wait(&_column);
+	if (ret) {
+		_detach();
+		_clear(matrix);
+		return ret;
+	}
+
+	// update matrix
+	for (uint8_t row=0; row<=5; row++)
+		KB_MATRIX_SET(matrix, row, col, !( _rows_data & (1<<(5-row)) ));
+
+	return 0;  // success
+}
+
+/* returns:
+ * - success: 0
+ * - failure: twi status code
+ */
+uint8_t mcp23018_update_matrix_end(void) {
+	uint8_t ret;
+
+	// set all columns hi-Z : 1
+	_column_data[1] = 0xFF;
+	_queue(&_release);
+	ret = twi_wait(&_release);
+
+	if (ret)
+		_detach();
+
+	return ret;
+}
+
+#endif
+
+
+/* ----------------------------------------------------------------------------
+ * idle probe
+ * ------------------------------------------------------------------------- */
+#if CONTROLLER__IDLE_PROBE
+
+/*
+ * Drive all columns (or rows) low at once, and check whether any of the
+ * inputs reads low
+ * - One transaction: write the driving port, repeated start, read the other
+ *   port (5 bytes)
+ * - The driving pins are left low: the next full scan sets them as it goes,
+ *   and releases them when it's done
+ *
+ * Arguments
+ * - `matrix`: cleared (our part), if the expander isn't responding
+ * - `down`: set to whether any key is down
+ *
+ * Returns
+ * - success: 0
+ * - failure: twi status code (or 1, if we're waiting to reprobe)
+ */
+uint8_t mcp23018_any_key_down( uint16_t matrix[KB_ROWS],
+                               bool * down ) {
+	uint8_t ret, data;
+
+	*down = false;
+
+	ret = _probe();
+	if (ret)
+		goto clear;
+
+	twi_start();
+	ret = twi_send(TWI_ADDR_WRITE);
+	if (ret) goto out;
+	#if MCP23018__DRIVE_ROWS
+		twi_send(GPIOB);
+		twi_send(0b11000000);  // set all rows low : 0
+	#elif MCP23018__DRIVE_COLUMNS
+		twi_send(GPIOA);
+		twi_send(0b10000000);  // set all columns low : 0
+	#endif
+	twi_start();
+	ret = twi_send(TWI_ADDR_READ);
+	if (ret) goto out;
+	twi_read_last(&data);
+	twi_stop();
+
+	#if MCP23018__DRIVE_ROWS
+		*down = ( (data & 0b01111111) != 0b01111111 );
+	#elif MCP23018__DRIVE_COLUMNS
+		*down = ( (data & 0b00111111) != 0b00111111 );
+	#endif
+
+	return 0;  // success
+
+out:
+	// the expander stopped responding
+	twi_stop();
+	_detach();
+
+clear:
+	_clear(matrix);
+	return ret;
+}
+
+#endif
+
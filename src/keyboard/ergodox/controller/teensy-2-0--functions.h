@@ -17,7 +17,14 @@
 	// --------------------------------------------------------------------
 
 	uint8_t teensy_init(void);
-	uint8_t teensy_update_matrix( bool matrix[KB_ROWS][KB_COLUMNS] );
+	uint8_t teensy_update_matrix( uint16_t matrix[KB_ROWS] );
+
+	// pipelined scanning (see "../controller.c")
+	void    teensy_update_column( uint16_t matrix[KB_ROWS],
+	                              uint8_t col );
+
+	// idle probe (see "../options.h")
+	bool    teensy_any_key_down(void);
 
 #endif
 
@@ -80,48 +80,168 @@
 #define  SET    |=
 #define  CLEAR  &=~
 
-#define  _teensypin_write(register, operation, pin_letter, pin_number)	\
-	do {								\
-		((register##pin_letter) operation (1<<(pin_number)));	\
-		_delay_us(1);  /* allow pins time to stabilize */	\
-	} while(0)
+#if TEENSY__CONSERVATIVE_DELAYS
+
+	// settle after every pin change (the original behavior)
+	#define  _teensypin_write(register, operation, pin_letter, pin_number) \
+		do {							\
+			((register##pin_letter) operation (1<<(pin_number))); \
+			_delay_us(1);  /* allow pins time to stabilize */ \
+		} while(0)
+
+	#define  teensypin_settle()
+
+#else
+
+	#define  _teensypin_write(register, operation, pin_letter, pin_number) \
+		((register##pin_letter) operation (1<<(pin_number)))
+
+	// settle once, between driving a pin and reading the inputs
+	#define  teensypin_settle()					\
+		__builtin_avr_delay_cycles(TEENSY__SETTLE_CYCLES)
+
+#endif
+
 #define  teensypin_write(register, operation, pin)	\
 	_teensypin_write(register, operation, pin)
 
-#define  _teensypin_read(pin_letter, pin_number)	\
-	((PIN##pin_letter) & (1<<(pin_number)))
-#define  teensypin_read(pin)	\
-	_teensypin_read(pin)
-
-#define  teensypin_write_all_unused(register, operation)		\
+/*
+ * whole port masks
+ * - `teensypin_mask(B, ROW_0)` is `(1<<n)` if `ROW_0` is pin `B, n`, and 0
+ *   otherwise.  The masks for a whole set of pins are then computed (at
+ *   compile time) for each port, from the pin macros above.
+ */
+#define  _TEENSYPORT_B  1
+#define  _TEENSYPORT_C  2
+#define  _TEENSYPORT_D  3
+#define  _TEENSYPORT_E  4
+#define  _TEENSYPORT_F  5
+
+#define  _teensypin_mask(port_letter, pin_letter, pin_number)		\
+	( (_TEENSYPORT_##port_letter == _TEENSYPORT_##pin_letter)	\
+	  ? (1<<(pin_number)) : 0 )
+#define  teensypin_mask(port_letter, pin)	\
+	_teensypin_mask(port_letter, pin)
+
+#define  unused_mask(port_letter)			\
+	( teensypin_mask(port_letter, UNUSED_0)		\
+	| teensypin_mask(port_letter, UNUSED_1)		\
+	| teensypin_mask(port_letter, UNUSED_2)		\
+	| teensypin_mask(port_letter, UNUSED_3)		\
+	| teensypin_mask(port_letter, UNUSED_4) )
+
+#define  row_mask(port_letter)				\
+	( teensypin_mask(port_letter, ROW_0)		\
+	| teensypin_mask(port_letter, ROW_1)		\
+	| teensypin_mask(port_letter, ROW_2)		\
+	| teensypin_mask(port_letter, ROW_3)		\
+	| teensypin_mask(port_letter, ROW_4)		\
+	| teensypin_mask(port_letter, ROW_5) )
+
+#define  column_mask(port_letter)			\
+	( teensypin_mask(port_letter, COLUMN_7)		\
+	| teensypin_mask(port_letter, COLUMN_8)		\
+	| teensypin_mask(port_letter, COLUMN_9)		\
+	| teensypin_mask(port_letter, COLUMN_A)		\
+	| teensypin_mask(port_letter, COLUMN_B)		\
+	| teensypin_mask(port_letter, COLUMN_C)		\
+	| teensypin_mask(port_letter, COLUMN_D) )
+
+// write `mask` to each port it has bits in (1 instruction or so per port)
+#define  _teensyport_write(register, operation, port_letter, mask)	\
 	do {								\
-		teensypin_write(register, operation, UNUSED_0);		\
-		teensypin_write(register, operation, UNUSED_1);		\
-		teensypin_write(register, operation, UNUSED_2);		\
-		teensypin_write(register, operation, UNUSED_3);		\
-		teensypin_write(register, operation, UNUSED_4); }	\
-	while(0)
-
-#define  teensypin_write_all_row(register, operation)		\
-	do {							\
-		teensypin_write(register, operation, ROW_0);	\
-		teensypin_write(register, operation, ROW_1);	\
-		teensypin_write(register, operation, ROW_2);	\
-		teensypin_write(register, operation, ROW_3);	\
-		teensypin_write(register, operation, ROW_4);	\
-		teensypin_write(register, operation, ROW_5); }	\
-	while(0)
-
-#define  teensypin_write_all_column(register, operation)		\
+		if (mask(port_letter))					\
+			((register##port_letter) operation		\
+			 (mask(port_letter)));				\
+	} while(0)
+#define  teensyport_write_all(register, operation, mask)		\
+	do {								\
+		_teensyport_write(register, operation, B, mask);	\
+		_teensyport_write(register, operation, C, mask);	\
+		_teensyport_write(register, operation, D, mask);	\
+		_teensyport_write(register, operation, E, mask);	\
+		_teensyport_write(register, operation, F, mask);	\
+	} while(0)
+
+/*
+ * whole port reads
+ * - `teensyport_read_all(pins, mask)` reads each port that has bits in `mask`
+ *   once (1 instruction per port; only port F, for the rows), into
+ *   `pins.B` .. `pins.F`.  The others aren't read.  The pins are then tested
+ *   with `teensypin_read_from()`, all as of the same instant.
+ * - `teensyport_any_low(mask)` is whether any of the pins in `mask` reads low,
+ *   again reading each port once.
+ */
+struct teensy_pins { uint8_t B, C, D, E, F; };
+
+#define  _teensyport_read(port_letter, mask)				\
+	( (mask(port_letter)) ? (PIN##port_letter) : 0xFF )
+#define  teensyport_read_all(pins, mask)				\
 	do {								\
-		teensypin_write(register, operation, COLUMN_7);		\
-		teensypin_write(register, operation, COLUMN_8);		\
-		teensypin_write(register, operation, COLUMN_9);		\
-		teensypin_write(register, operation, COLUMN_A);		\
-		teensypin_write(register, operation, COLUMN_B);		\
-		teensypin_write(register, operation, COLUMN_C);		\
-		teensypin_write(register, operation, COLUMN_D); }	\
-	while(0)
+		(pins).B = _teensyport_read(B, mask);			\
+		(pins).C = _teensyport_read(C, mask);			\
+		(pins).D = _teensyport_read(D, mask);			\
+		(pins).E = _teensyport_read(E, mask);			\
+		(pins).F = _teensyport_read(F, mask);			\
+	} while(0)
+
+#define  _teensypin_read_from(pins, pin_letter, pin_number)	\
+	((pins).pin_letter & (1<<(pin_number)))
+#define  teensypin_read_from(pins, pin)	\
+	_teensypin_read_from(pins, pin)
+
+#define  _teensyport_any_low(port_letter, mask)			\
+	( (mask(port_letter))						\
+	  && ( ~(PIN##port_letter) & (mask(port_letter)) ) )
+#define  teensyport_any_low(mask)					\
+	( _teensyport_any_low(B, mask) || _teensyport_any_low(C, mask)	\
+	  || _teensyport_any_low(D, mask) || _teensyport_any_low(E, mask) \
+	  || _teensyport_any_low(F, mask) )
+
+#if TEENSY__CONSERVATIVE_DELAYS
+
+	#define  teensypin_write_all_unused(register, operation)	\
+		do {							\
+			teensypin_write(register, operation, UNUSED_0);	\
+			teensypin_write(register, operation, UNUSED_1);	\
+			teensypin_write(register, operation, UNUSED_2);	\
+			teensypin_write(register, operation, UNUSED_3);	\
+			teensypin_write(register, operation, UNUSED_4); } \
+		while(0)
+
+	#define  teensypin_write_all_row(register, operation)		\
+		do {							\
+			teensypin_write(register, operation, ROW_0);	\
+			teensypin_write(register, operation, ROW_1);	\
+			teensypin_write(register, operation, ROW_2);	\
+			teensypin_write(register, operation, ROW_3);	\
+			teensypin_write(register, operation, ROW_4);	\
+			teensypin_write(register, operation, ROW_5); }	\
+		while(0)
+
+	#define  teensypin_write_all_column(register, operation)	\
+		do {							\
+			teensypin_write(register, operation, COLUMN_7);	\
+			teensypin_write(register, operation, COLUMN_8);	\
+			teensypin_write(register, operation, COLUMN_9);	\
+			teensypin_write(register, operation, COLUMN_A);	\
+			teensypin_write(register, operation, COLUMN_B);	\
+			teensypin_write(register, operation, COLUMN_C);	\
+			teensypin_write(register, operation, COLUMN_D); } \
+		while(0)
+
+#else
+
+	#define  teensypin_write_all_unused(register, operation)	\
+		teensyport_write_all(register, operation, unused_mask)
+
+	#define  teensypin_write_all_row(register, operation)		\
+		teensyport_write_all(register, operation, row_mask)
+
+	#define  teensypin_write_all_column(register, operation)	\
+		teensyport_write_all(register, operation, column_mask)
+
+#endif
 
 
 /*
@@ -129,35 +249,57 @@
  */
 #define  update_rows_for_column(matrix, column)				\
 	do {								\
+		struct teensy_pins pins;				\
 		/* set column low (set as output) */			\
 		teensypin_write(DDR, SET, COLUMN_##column);		\
-		/* read rows 0..5 and update matrix */			\
-		matrix[0x0][0x##column] = ! teensypin_read(ROW_0);	\
-		matrix[0x1][0x##column] = ! teensypin_read(ROW_1);	\
-		matrix[0x2][0x##column] = ! teensypin_read(ROW_2);	\
-		matrix[0x3][0x##column] = ! teensypin_read(ROW_3);	\
-		matrix[0x4][0x##column] = ! teensypin_read(ROW_4);	\
-		matrix[0x5][0x##column] = ! teensypin_read(ROW_5);	\
+		teensypin_settle();					\
+		/* read rows 0..5 (at once) and update matrix */	\
+		teensyport_read_all(pins, row_mask);			\
+		KB_MATRIX_SET(matrix, 0x0, 0x##column,			\
+		              ! teensypin_read_from(pins, ROW_0));	\
+		KB_MATRIX_SET(matrix, 0x1, 0x##column,			\
+		              ! teensypin_read_from(pins, ROW_1));	\
+		KB_MATRIX_SET(matrix, 0x2, 0x##column,			\
+		              ! teensypin_read_from(pins, ROW_2));	\
+		KB_MATRIX_SET(matrix, 0x3, 0x##column,			\
+		              ! teensypin_read_from(pins, ROW_3));	\
+		KB_MATRIX_SET(matrix, 0x4, 0x##column,			\
+		              ! teensypin_read_from(pins, ROW_4));	\
+		KB_MATRIX_SET(matrix, 0x5, 0x##column,			\
+		              ! teensypin_read_from(pins, ROW_5));	\
 		/* set column hi-Z (set as input) */			\
 		teensypin_write(DDR, CLEAR, COLUMN_##column);		\
 	} while(0)
 
 #define  update_columns_for_row(matrix, row)				\
 	do {								\
+		struct teensy_pins pins;				\
 		/* set row low (set as output) */			\
 		teensypin_write(DDR, SET, ROW_##row);			\
-		/* read columns 7..D and update matrix */		\
-		matrix[0x##row][0x7] = ! teensypin_read(COLUMN_7);	\
-		matrix[0x##row][0x8] = ! teensypin_read(COLUMN_8);	\
-		matrix[0x##row][0x9] = ! teensypin_read(COLUMN_9);	\
-		matrix[0x##row][0xA] = ! teensypin_read(COLUMN_A);	\
-		matrix[0x##row][0xB] = ! teensypin_read(COLUMN_B);	\
-		matrix[0x##row][0xC] = ! teensypin_read(COLUMN_C);	\
-		matrix[0x##row][0xD] = ! teensypin_read(COLUMN_D);	\
+		teensypin_settle();					\
+		/* read columns 7..D (at once) and update matrix */	\
+		teensyport_read_all(pins, column_mask);			\
+		KB_MATRIX_SET(matrix, 0x##row, 0x7,			\
+		              ! teensypin_read_from(pins, COLUMN_7));	\
+		KB_MATRIX_SET(matrix, 0x##row, 0x8,			\
+		              ! teensypin_read_from(pins, COLUMN_8));	\
+		KB_MATRIX_SET(matrix, 0x##row, 0x9,			\
+		              ! teensypin_read_from(pins, COLUMN_9));	\
+		KB_MATRIX_SET(matrix, 0x##row, 0xA,			\
+		              ! teensypin_read_from(pins, COLUMN_A));	\
+		KB_MATRIX_SET(matrix, 0x##row, 0xB,			\
+		              ! teensypin_read_from(pins, COLUMN_B));	\
+		KB_MATRIX_SET(matrix, 0x##row, 0xC,			\
+		              ! teensypin_read_from(pins, COLUMN_C));	\
+		KB_MATRIX_SET(matrix, 0x##row, 0xD,			\
+		              ! teensypin_read_from(pins, COLUMN_D));	\
 		/* set row hi-Z (set as input) */			\
 		teensypin_write(DDR, CLEAR, ROW_##row);			\
 	} while(0)
 
+#define  any_row_low()		teensyport_any_low(row_mask)
+#define  any_column_low()	teensyport_any_low(column_mask)
+
 // ----------------------------------------------------------------------------
 
 /* returns
@@ -212,7 +354,7 @@ uint8_t teensy_init(void) {
 	#error "Expecting different keyboard dimensions"
 #endif
 
-uint8_t teensy_update_matrix(bool matrix[KB_ROWS][KB_COLUMNS]) {
+uint8_t teensy_update_matrix(uint16_t matrix[KB_ROWS]) {
 	#if TEENSY__DRIVE_ROWS
 		update_columns_for_row(matrix, 0);
 		update_columns_for_row(matrix, 1);
@@ -232,3 +374,45 @@ uint8_t teensy_update_matrix(bool matrix[KB_ROWS][KB_COLUMNS]) {
 
 	return 0;  // success
 }
+
+#if CONTROLLER__PIPELINED_SCAN
+/*
+ * Update the rows for a single column (0x7..0xD)
+ */
+void teensy_update_column(uint16_t matrix[KB_ROWS], uint8_t col) {
+	switch (col) {
+		case 0x7: update_rows_for_column(matrix, 7); break;
+		case 0x8: update_rows_for_column(matrix, 8); break;
+		case 0x9: update_rows_for_column(matrix, 9); break;
+		case 0xA: update_rows_for_column(matrix, A); break;
+		case 0xB: update_rows_for_column(matrix, B); break;
+		case 0xC: update_rows_for_column(matrix, C); break;
+		case 0xD: update_rows_for_column(matrix, D); break;
+	}
+}
+#endif
+
+#if CONTROLLER__IDLE_PROBE
+/*
+ * Drive all columns (or rows) low at once, and check whether any of the
+ * inputs reads low
+ */
+bool teensy_any_key_down(void) {
+	bool down;
+
+	#if TEENSY__DRIVE_ROWS
+		teensypin_write_all_row(DDR, SET);       // set low (as output)
+		teensypin_settle();
+		down = any_column_low();
+		teensypin_write_all_row(DDR, CLEAR);     // set hi-Z (as input)
+	#elif TEENSY__DRIVE_COLUMNS
+		teensypin_write_all_column(DDR, SET);    // set low (as output)
+		teensypin_settle();
+		down = any_row_low();
+		teensypin_write_all_column(DDR, CLEAR);  // set hi-Z (as input)
+	#endif
+
+	return down;
+}
+#endif
+
@@ -1,7 +1,12 @@
 /* ----------------------------------------------------------------------------
  * ergoDOX : layout : COLEMAK : exports
- * 
+ *
+ * Modified from the Kinesis layout.
+ *
  * Submitted by Jason Trill [jjt] (https://github.com/jjt)
+ *
+ * Generated by "build-scripts/gen-keymap.py" from "colemak-symbol-mod.json".
+ * Edit that, and regenerate, instead of editing this file.
  * ----------------------------------------------------------------------------
  * Copyright (c) 2012 Ben Blazak <benblazak.dev@gmail.com>
  * Released under The MIT License (MIT) (see "license.md")
@@ -25,7 +30,15 @@
 
 	// --------------------------------------------------------------------
 
+	#define KB_LAYERS 4
+
+	// the number of actions in `_kb_actions`, and a bitmap of the ones whose
+	// keycode is a layer number
+	#define KB_ACTIONS        12
+	#define KB_LAYER_ACTIONS  0xAE0ULL
+
 	#include "./default--led-control.h"
+	#include "./default--sparse-matrix-control.h"
 	#include "./default--matrix-control.h"
 
 #endif
@@ -27,7 +27,13 @@
 	/*
 	 * matrix 'get' macros, and `extern` matrix declarations
 	 *
-	 * These are written for when the matrices are stored solely in Flash.
+	 * Each key, on each layer, is one 16-bit action word: the high byte is
+	 * an index into the layout's table of actions (pairs of press and
+	 * release functions), and the low byte is the key's keycode (or, for
+	 * layer functions, a layer number).  Looking up a key is then one read
+	 * from flash; the table of actions is small, and kept in RAM.
+	 *
+	 * These are written for when the matrix is stored solely in Flash.
 	 * Layouts may redefine them if they wish and use Flash, RAM, EEPROM,
 	 * or any combination of the three, as long as they maintain the same
 	 * interface.
@@ -35,46 +41,104 @@
 	 * - If the macro is overridden, the matrix declaration must be too,
 	 *   and vice versa.
 	 *
-	 * - 'set' functions are optional, and should be defined in the layout
-	 *   specific '.h'.  They'll require the use of the EEPROM, possibly in
-	 *   clever conjunction with one of the other two memories (since the
-	 *   EEPROM is small).  Custom key functions will also need to be
-	 *   written.
+	 * - 'set' functions are optional.  "lib/eeprom-keymap.h" provides
+	 *   one (`eeprom_keymap_set()`) for layouts that use these macros;
+	 *   layouts that override them will have to provide their own.
 	 *
 	 * - To override these macros with real functions, set the macro equal
-	 *   to itself (e.g. `#define kb_layout_get kb_layout_get`) and provide
-	 *   function prototypes, in the layout specific '.h'
+	 *   to itself (e.g. `#define kb_layout_action_get
+	 *   kb_layout_action_get`) and provide function prototypes, in the
+	 *   layout specific '.h'
+	 *
+	 * - `kb_layout_flash_action_get()` is the layout as stored in flash.
+	 *   Unless the layout overrides `kb_layout_action_get()`, keys are
+	 *   looked up there, or (if enabled in the makefile) through
+	 *   "lib/eeprom-keymap.h", which applies the keys remapped at runtime
+	 *   on top of it.  Layouts whose transparent keys were resolved when
+	 *   they were generated (`KB_TRANSPARENCY_RESOLVED`) can't be used
+	 *   that way: remaps wouldn't carry up through those keys.
+	 *
+	 * - `kb_action_valid()` is for action words that don't come from the
+	 *   layout itself (e.g. keys remapped at runtime): it's true if the
+	 *   action is in the layout's table, and (for layer functions) the
+	 *   layer exists.  It needs `KB_ACTIONS` and `KB_LAYER_ACTIONS` (as
+	 *   written by "build-scripts/gen-keymap.py").
 	 */
 
-	#ifndef kb_layout_get
-		extern const uint8_t PROGMEM \
-			       _kb_layout[KB_LAYERS][KB_ROWS][KB_COLUMNS];
+	#define KB_ACTION(action, keycode) \
+		( (uint16_t) ( ((action) << 8) | (keycode) ) )
+
+	#ifndef kb_layout_flash_action_get
+		extern const uint16_t PROGMEM \
+			_kb_layout_actions[KB_LAYERS][KB_ROWS][KB_COLUMNS];
+
+		#define kb_layout_flash_action_get(layer,row,column) \
+			( (uint16_t) \
+			  pgm_read_word(&( \
+				_kb_layout_actions[layer][row][column] )) )
+	#endif
+
+	#ifndef kb_layout_action_get
+		#if MAKEFILE_EEPROM_KEYMAP
+			#if KB_TRANSPARENCY_RESOLVED
+				#error "regenerate the layout with `--remappable` " \
+				       "(`make keymap` does)"
+			#endif
+			#include "../../../lib/eeprom-keymap.h"
+
+			#define kb_layout_action_get(layer,row,column) \
+				eeprom_keymap_action_get(layer,row,column)
+		#else
+			#define kb_layout_action_get(layer,row,column) \
+				kb_layout_flash_action_get(layer,row,column)
+		#endif
+	#endif
+
+	#ifndef kb_action_press_get
+		extern const void_funptr_t _kb_actions[][2];
 
+		#define kb_action_keycode(action) \
+			( (uint8_t) (action) )
+		#define kb_action_press_get(action) \
+			( _kb_actions[(action) >> 8][0] )
+		#define kb_action_release_get(action) \
+			( _kb_actions[(action) >> 8][1] )
+	#endif
+
+	#ifndef kb_action_valid
+		#define kb_action_valid(action) \
+			( ((action) >> 8) < KB_ACTIONS \
+			  && ( !( KB_LAYER_ACTIONS & (1ULL << ((action) >> 8)) ) \
+			       || kb_action_keycode(action) < KB_LAYERS ) )
+	#endif
+
+	// --------------------------------------------------------------------
+
+	/*
+	 * compatibility 'get' macros
+	 *
+	 * For code written against the old layout format (with a keycode, a
+	 * press function, and a release function matrix).  Each of these
+	 * reads the whole action word, so code that wants more than one
+	 * should use `kb_layout_action_get()` instead.
+	 */
+
+	#ifndef kb_layout_get
 		#define kb_layout_get(layer,row,column) \
-			( (uint8_t) \
-			  pgm_read_byte(&( \
-				_kb_layout[layer][row][column] )) )
+			kb_action_keycode( \
+				kb_layout_action_get(layer,row,column) )
 	#endif
 
 	#ifndef kb_layout_press_get
-		extern const void_funptr_t PROGMEM \
-			_kb_layout_press[KB_LAYERS][KB_ROWS][KB_COLUMNS];
-
 		#define kb_layout_press_get(layer,row,column) \
-			( (void_funptr_t) \
-			  pgm_read_word(&( \
-				_kb_layout_press[layer][row][column] )) )
+			kb_action_press_get( \
+				kb_layout_action_get(layer,row,column) )
 	#endif
 
 	#ifndef kb_layout_release_get
-		extern const void_funptr_t PROGMEM \
-			_kb_layout_release[KB_LAYERS][KB_ROWS][KB_COLUMNS];
-
 		#define kb_layout_release_get(layer,row,column) \
-			( (void_funptr_t) \
-			  pgm_read_word(&( \
-				_kb_layout_release[layer][row][column] )) )
-
+			kb_action_release_get( \
+				kb_layout_action_get(layer,row,column) )
 	#endif
 
 #endif
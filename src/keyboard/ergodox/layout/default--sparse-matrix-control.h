@@ -0,0 +1,169 @@
+/* ----------------------------------------------------------------------------
+ * ergoDOX : layout : default sparse matrix control
+ *
+ * For layouts whose layers (other than the base layer) are mostly transparent.
+ * To use, include this file before "default--matrix-control.h" in the layout
+ * specific '.h'.
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2026 agent <agent@local>
+ * Released under The MIT License (MIT) (see "license.md")
+ * Project located at <https://github.com/benblazak/ergodox-firmware>
+ * ------------------------------------------------------------------------- */
+
+
+#ifndef KEYBOARD__ERGODOX__LAYOUT__DEFAULT__SPARSE_MATRIX_CONTROL_h
+	#define KEYBOARD__ERGODOX__LAYOUT__DEFAULT__SPARSE_MATRIX_CONTROL_h
+
+	#include <stdint.h>
+	#include <avr/pgmspace.h>
+	#include "../matrix.h"
+
+	// --------------------------------------------------------------------
+
+	#ifndef KB_LAYERS
+		#define KB_LAYERS 10
+	#endif
+
+	// --------------------------------------------------------------------
+
+	/*
+	 * sparse layers
+	 *
+	 * - Layer 0 (the base layer) is a full matrix of action words, as
+	 *   usual.
+	 *
+	 * - Every other layer is a list of the keys it overrides, as
+	 *   `(position, action)` pairs, plus a 'fill' action word for all the
+	 *   keys it doesn't (usually transparent).
+	 *   - Positions are one byte, `0x##`, where the digits are the row and
+	 *     column of the key in the matrix (the same as the `k##` names in
+	 *     "../matrix.h").
+	 *   - Lists must be in order of position.
+	 *
+	 * - Each layer has an index: for every row, a bitmap of the columns it
+	 *   overrides, and a pointer to the row's first override.  Looking up
+	 *   a key is then at most 3 words read from flash (the bitmap, the
+	 *   pointer, and the action word) no matter how many layers there
+	 *   are, or how many keys they override.
+	 *
+	 * - Each layer takes 26 bytes (for the index), plus 2 bytes per key it
+	 *   overrides.
+	 *
+	 * Layers are written as a macro taking the name of another macro, and
+	 * calling it once for each override; e.g.
+	 *
+	 *     #define  LAYER_1(O)                  \
+	 *         O( 0x51, K(prrel, _F1) )         \
+	 *         O( 0x52, K(prrel, _F2) )
+	 *
+	 *     KB_SPARSE_LAYER_ACTIONS( LAYER_1 );
+	 *
+	 *     const uint16_t PROGMEM
+	 *         _kb_layout_base[KB_ROWS][KB_COLUMNS] =
+	 *             KB_MATRIX_LAYER( ... );
+	 *
+	 *     const struct kb_sparse_layer PROGMEM
+	 *         _kb_layout_sparse[KB_LAYERS-1] = {
+	 *             KB_SPARSE_LAYER( LAYER_1, K(trans, 0) ),
+	 *         };
+	 *
+	 * Layer `n` (for `n > 0`) is `_kb_layout_sparse[n-1]`.  Layers that
+	 * aren't defined are all 0 (no action).
+	 */
+
+	struct kb_sparse_row {
+		uint16_t         bits;   // bit `column` set if it's overridden
+		const uint16_t * first;  // the first override in this row
+	};
+
+	struct kb_sparse_layer {
+		struct kb_sparse_row rows[KB_ROWS];
+		uint16_t             fill;  // for keys that aren't overridden
+	};
+
+	extern const uint16_t PROGMEM \
+		_kb_layout_base[KB_ROWS][KB_COLUMNS];
+	extern const struct kb_sparse_layer PROGMEM \
+		_kb_layout_sparse[KB_LAYERS-1];
+
+	// --------------------------------------------------------------------
+
+	#define kb_layout_flash_action_get kb_layout_flash_action_get
+	static inline uint16_t kb_layout_flash_action_get( uint8_t layer,
+	                                                   uint8_t row,
+	                                                   uint8_t column ) {
+		if (!layer)
+			return pgm_read_word(&( _kb_layout_base[row][column] ));
+
+		const struct kb_sparse_layer * l = &_kb_layout_sparse[layer-1];
+
+		uint16_t bits = pgm_read_word(&( l->rows[row].bits ));
+		uint16_t bit  = 1U << column;
+
+		if (!(bits & bit))
+			return pgm_read_word(&( l->fill ));
+
+		const uint16_t * first =
+			(const uint16_t *) pgm_read_word(&( l->rows[row].first ));
+
+		// skip the overrides earlier in the row
+		return pgm_read_word( first + __builtin_popcount(bits & (bit-1)) );
+	}
+
+	// --------------------------------------------------------------------
+
+	/*
+	 * layer definition macros
+	 */
+
+	// the list of action words, for `list`
+	#define KB_SPARSE_LAYER_ACTIONS(list) \
+		static const uint16_t PROGMEM list##_actions[] = { \
+			list(_KB_SPARSE_ACTION) }
+
+	// the index of `list` (whose actions must already be defined)
+	#define KB_SPARSE_LAYER(list, fill_action) \
+		{ .rows = { _KB_SPARSE_ROW(list, 0), \
+		            _KB_SPARSE_ROW(list, 1), \
+		            _KB_SPARSE_ROW(list, 2), \
+		            _KB_SPARSE_ROW(list, 3), \
+		            _KB_SPARSE_ROW(list, 4), \
+		            _KB_SPARSE_ROW(list, 5) }, \
+		  .fill = (fill_action) }
+
+	#if KB_ROWS != 6
+		#error "`KB_SPARSE_LAYER()` needs updating for `KB_ROWS`"
+	#endif
+
+	// --- (private) ------------------------------------------------------
+
+	#define _KB_SPARSE_ACTION(position, action)  (action),
+
+	#define _KB_SPARSE_ROW(list, row) \
+		{ .bits  = (0 list(_KB_SPARSE_BITS_##row)), \
+		  .first = &list##_actions[0 list(_KB_SPARSE_BEFORE_##row)] }
+
+	// `| (bit of 'position')`, if 'position' is in row 'row'
+	#define _KB_SPARSE_BIT(row, position) \
+		| ( ((position) >> 4) == (row) ? 1U << ((position) & 0xF) : 0 )
+
+	// `+ 1`, if 'position' is in a row before 'row'
+	#define _KB_SPARSE_COUNT(row, position) \
+		+ ( ((position) >> 4) < (row) )
+
+	#define _KB_SPARSE_BITS_0(p, a)    _KB_SPARSE_BIT(0, p)
+	#define _KB_SPARSE_BITS_1(p, a)    _KB_SPARSE_BIT(1, p)
+	#define _KB_SPARSE_BITS_2(p, a)    _KB_SPARSE_BIT(2, p)
+	#define _KB_SPARSE_BITS_3(p, a)    _KB_SPARSE_BIT(3, p)
+	#define _KB_SPARSE_BITS_4(p, a)    _KB_SPARSE_BIT(4, p)
+	#define _KB_SPARSE_BITS_5(p, a)    _KB_SPARSE_BIT(5, p)
+
+	#define _KB_SPARSE_BEFORE_0(p, a)  _KB_SPARSE_COUNT(0, p)
+	#define _KB_SPARSE_BEFORE_1(p, a)  _KB_SPARSE_COUNT(1, p)
+	#define _KB_SPARSE_BEFORE_2(p, a)  _KB_SPARSE_COUNT(2, p)
+	#define _KB_SPARSE_BEFORE_3(p, a)  _KB_SPARSE_COUNT(3, p)
+	#define _KB_SPARSE_BEFORE_4(p, a)  _KB_SPARSE_COUNT(4, p)
+	#define _KB_SPARSE_BEFORE_5(p, a)  _KB_SPARSE_COUNT(5, p)
+
+#endif
+
@@ -1,5 +1,10 @@
 /* ----------------------------------------------------------------------------
  * ergoDOX : layout : Dvorak : exports
+ *
+ * Modified from the Kinesis layout.
+ *
+ * Generated by "build-scripts/gen-keymap.py" from "dvorak-kinesis-mod.json".
+ * Edit that, and regenerate, instead of editing this file.
  * ----------------------------------------------------------------------------
  * Copyright (c) 2012 Ben Blazak <benblazak.dev@gmail.com>
  * Released under The MIT License (MIT) (see "license.md")
@@ -23,7 +28,15 @@
 
 	// --------------------------------------------------------------------
 
+	#define KB_LAYERS 4
+
+	// the number of actions in `_kb_actions`, and a bitmap of the ones whose
+	// keycode is a layer number
+	#define KB_ACTIONS        12
+	#define KB_LAYER_ACTIONS  0x2E0ULL
+
 	#include "./default--led-control.h"
+	#include "./default--sparse-matrix-control.h"
 	#include "./default--matrix-control.h"
 
 #endif
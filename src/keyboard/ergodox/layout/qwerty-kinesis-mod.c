@@ -1,5 +1,10 @@
 /* ----------------------------------------------------------------------------
- * ergoDOX layout : QWERTY (modified from the Kinesis layout)
+ * ergoDOX layout : QWERTY
+ *
+ * Modified from the Kinesis layout.
+ *
+ * Generated by "build-scripts/gen-keymap.py" from "qwerty-kinesis-mod.json".
+ * Edit that, and regenerate, instead of editing this file.
  * ----------------------------------------------------------------------------
  * Copyright (c) 2012 Ben Blazak <benblazak.dev@gmail.com>
  * Released under The MIT License (MIT) (see "license.md")
@@ -19,104 +24,6 @@
 // ----------------------------------------------------------------------------
 // ----------------------------------------------------------------------------
 
-const uint8_t PROGMEM _kb_layout[KB_LAYERS][KB_ROWS][KB_COLUMNS] = {
-
-	KB_MATRIX_LAYER(  // layout: layer 0: default
-// unused
-0,
-// left hand
-    _equal,     _1,         _2,      _3,      _4,    _5, _esc,
-_backslash,     _Q,         _W,      _E,      _R,    _T,    1,
-      _tab,     _A,         _S,      _D,      _F,    _G,
-   _shiftL,     _Z,         _X,      _C,      _V,    _B,    1,
-     _guiL, _grave, _backslash, _arrowL, _arrowR,
-                                                 _ctrlL, _altL,
-                                              0,      0, _home,
-                                            _bs,   _del,  _end,
-// right hand
-        3, _6,      _7,      _8,      _9,         _0,     _dash,
-_bracketL, _Y,      _U,      _I,      _O,         _P, _bracketR,
-           _H,      _J,      _K,      _L, _semicolon,    _quote,
-        1, _N,      _M,  _comma, _period,     _slash,   _shiftR,
-               _arrowL, _arrowD, _arrowU,    _arrowR,     _guiR,
- _altR, _ctrlR,
-_pageU,      0,      0,
-_pageD, _enter, _space ),
-
-
-	KB_MATRIX_LAYER(  // layout: layer 1: function and symbol keys
-// unused
-0,
-// left hand
-  0,        _F1,        _F2,       _F3,       _F4,       _F5, _F11,
-  0,  _bracketL,  _bracketR, _bracketL, _bracketR,         0,    1,
-  0, _semicolon,     _slash,     _dash,     _0_kp,_semicolon,
-  0,      _6_kp,      _7_kp,     _8_kp,     _9_kp,    _equal,    2,
-  0,          0,          0,         0,         0,
-                                                             0,  0,
-                                                         0,  0,  0,
-                                                         0,  0,  0,
-// right hand
-_F12,       _F6,    _F7,       _F8,       _F9,         _F10,   _power,
-   0,         0,  _dash,    _comma,   _period,_currencyUnit, _volumeU,
-     _backslash,  _1_kp,        _9,        _0,       _equal, _volumeD,
-   2,        _8,  _2_kp,     _3_kp,     _4_kp,        _5_kp,    _mute,
-                      0,         0,         0,            0,        0,
-  0,  0,
-  0,  0,  0,
-  0,  0,  0 ),
-
-
-	KB_MATRIX_LAYER(  // layout: layer 2: keyboard functions
-// unused
-0,
-// left hand
-  0,  0,  0,  0,  0,  0,  0,
-  0,  0,  0,  0,  0,  0,  0,
-  0,  0,  0,  0,  0,  0,
-  0,  0,  0,  0,  0,  0,  0,
-  0,  0,  0,  0,  0,
-		          0,  0,
-		      0,  0,  0,
-		      0,  0,  0,
-// right hand
-      0,  0,  0,  0,  0,  0,  0,
-      0,  0,  0,  0,  0,  0,  0,
-	  0,  0,  0,  0,  0,  0,
-      0,  0,  0,  0,  0,  0,  0,
-	      0,  0,  0,  0,  0,
-  0,  0,
-  0,  0,  0,
-  0,  0,  0 ),
-
-
-	KB_MATRIX_LAYER(  // layout: layer 3: numpad
-// unused
-0,
-// left hand
-0,       0, 0, 0, 0, 0, 0,
-0,       0, 0, 0, 0, 0, 0,
-0,       0, 0, 0, 0, 0,
-0,       0, 0, 0, 0, 0, 0,
-0, _insert, 0, 0, 0,
-                     0, 0,
-                  0, 0, 0,
-                  0, 0, 0,
-// right hand
-3, 0,     3, _equal_kp, _div_kp,   _mul_kp, 0,
-0, 0, _7_kp,     _8_kp,   _9_kp,   _sub_kp, 0,
-   0, _4_kp,     _5_kp,   _6_kp,   _add_kp, 0,
-0, 0, _1_kp,     _2_kp,   _3_kp, _enter_kp, 0,
-          0,         0, _period, _enter_kp, 0,
-0, 0,
-0, 0,     0,
-0, 0, _0_kp ),
-
-};
-
-// ----------------------------------------------------------------------------
-// ----------------------------------------------------------------------------
-
 // aliases
 
 // basic
@@ -158,213 +65,162 @@ _F12,       _F6,    _F7,       _F8,       _F9,         _F10,   _power,
 // ----------------------------------------------------------------------------
 // ----------------------------------------------------------------------------
 
-const void_funptr_t PROGMEM _kb_layout_press[KB_LAYERS][KB_ROWS][KB_COLUMNS] = {
-
-	KB_MATRIX_LAYER(  // press: layer 0: default
-// unused
-NULL,
-// left hand
- kprrel, kprrel, kprrel, kprrel, kprrel, kprrel, kprrel,
- kprrel, kprrel, kprrel, kprrel, kprrel, kprrel, lpush1,
- kprrel, kprrel, kprrel, kprrel, kprrel, kprrel,
- s2kcap, kprrel, kprrel, kprrel, kprrel, kprrel, lpush1,
- kprrel, kprrel, kprrel, kprrel, kprrel,
-                                                 kprrel, kprrel,
-                                           NULL,   NULL, kprrel,
-                                         kprrel, kprrel, kprrel,
-// right hand
-        slpunum, kprrel, kprrel, kprrel, kprrel, kprrel, kprrel,
-         kprrel, kprrel, kprrel, kprrel, kprrel, kprrel, kprrel,
-                 kprrel, kprrel, kprrel, kprrel, kprrel, kprrel,
-         lpush1, kprrel, kprrel, kprrel, kprrel, kprrel, s2kcap,
-                         kprrel, kprrel, kprrel, kprrel, kprrel,
- kprrel, kprrel,
- kprrel,   NULL,   NULL,
- kprrel, kprrel, kprrel ),
-
-
-	KB_MATRIX_LAYER(  // press: layer 1: function and symbol keys
-// unused
-NULL,
-// left hand
-   NULL, kprrel, kprrel, kprrel, kprrel, kprrel, kprrel,
- ktrans,sshprre,sshprre, kprrel, kprrel,   NULL,  lpop1,
- ktrans, kprrel, kprrel, kprrel, kprrel,sshprre,
- ktrans, kprrel, kprrel, kprrel, kprrel,sshprre, lpush2,
- ktrans, ktrans, ktrans, ktrans, ktrans,
-                                                 ktrans, ktrans,
-                                         ktrans, ktrans, ktrans,
-                                         ktrans, ktrans, ktrans,
-// right hand
-        kprrel, kprrel, kprrel, kprrel, kprrel, kprrel, kprrel,
-        ktrans,   NULL, kprrel,sshprre,sshprre, kprrel, kprrel,
-                kprrel, kprrel,sshprre,sshprre,sshprre, kprrel,
-        lpush2,sshprre, kprrel, kprrel, kprrel, kprrel, kprrel,
-                        ktrans, ktrans, ktrans, ktrans, ktrans,
- ktrans, ktrans,
- ktrans, ktrans, ktrans,
- ktrans, ktrans, ktrans ),
-
-
-	KB_MATRIX_LAYER(  // press: layer 2: keyboard functions
-// unused
-NULL,
-// left hand
- dbtldr,   NULL,   NULL,   NULL,   NULL,   NULL,   NULL,
-   NULL,   NULL,   NULL,   NULL,   NULL,   NULL,   NULL,
-   NULL,   NULL,   NULL,   NULL,   NULL,   NULL,
-   NULL,   NULL,   NULL,   NULL,   NULL,   NULL,   NULL,
-   NULL,   NULL,   NULL,   NULL,   NULL,
-                                                   NULL,   NULL,
-                                           NULL,   NULL,   NULL,
-                                           NULL,   NULL,   NULL,
-// right hand
-          NULL,   NULL,   NULL,   NULL,   NULL,   NULL,   NULL,
-          NULL,   NULL,   NULL,   NULL,   NULL,   NULL,   NULL,
-                  NULL,   NULL,   NULL,   NULL,   NULL,   NULL,
-          NULL,   NULL,   NULL,   NULL,   NULL,   NULL,   NULL,
-                          NULL,   NULL,   NULL,   NULL,   NULL,
-   NULL,   NULL,
-   NULL,   NULL,   NULL,
-   NULL,   NULL,   NULL ),
-
-
-	KB_MATRIX_LAYER(  // press: layer 3: numpad
-// unused
-NULL,
-// left hand
- ktrans, ktrans, ktrans, ktrans, ktrans, ktrans, ktrans,
- ktrans, ktrans, ktrans, ktrans, ktrans, ktrans, ktrans,
- ktrans, ktrans, ktrans, ktrans, ktrans, ktrans,
- ktrans, ktrans, ktrans, ktrans, ktrans, ktrans, ktrans,
- ktrans, kprrel, ktrans, ktrans, ktrans,
-                                                 ktrans, ktrans,
-                                         ktrans, ktrans, ktrans,
-                                         ktrans, ktrans, ktrans,
-// right hand
-       slponum, ktrans,slponum, kprrel, kprrel, kprrel, ktrans,
-        ktrans, ktrans, kprrel, kprrel, kprrel, kprrel, ktrans,
-                ktrans, kprrel, kprrel, kprrel, kprrel, ktrans,
-        ktrans, ktrans, kprrel, kprrel, kprrel, kprrel, ktrans,
-                        ktrans, ktrans, kprrel, kprrel, ktrans,
- ktrans, ktrans,
- ktrans, ktrans, ktrans,
- ktrans, ktrans, kprrel ),
+// actions: what a key does when it's pressed, and when it's released
+// - each key's action word (below) has the index of its action in this table
+//   in the high byte, and its keycode (or layer number) in the low byte
+// - this table is small, so it's kept in RAM, and looking up a key only takes
+//   one read from flash
+
+enum actions {
+	a_none,  // must be first (unused positions are 0)
+	a_prrel,
+	a_trans,
+	a_shprre,
+	a_2kcap,
+	a_hold1,
+	a_hold2,
+	a_push1,
+	a_pop1,
+	a_punum,
+	a_ponum,
+	a_btldr,
+};
 
+const void_funptr_t _kb_actions[][2] = {
+	             // press    release
+	[a_none  ] = { NULL,    NULL    },
+	[a_prrel ] = { kprrel,  kprrel  },
+	[a_trans ] = { ktrans,  ktrans  },
+	[a_shprre] = { sshprre, sshprre },
+	[a_2kcap ] = { s2kcap,  s2kcap  },
+	[a_hold1 ] = { lpush1,  lpop1   },
+	[a_hold2 ] = { lpush2,  lpop2   },
+	[a_push1 ] = { lpush1,  NULL    },
+	[a_pop1  ] = { lpop1,   NULL    },
+	[a_punum ] = { slpunum, NULL    },
+	[a_ponum ] = { slponum, NULL    },
+	[a_btldr ] = { dbtldr,  NULL    },
 };
 
+#define  K(action, keycode)  KB_ACTION(a_##action, keycode)
+
 // ----------------------------------------------------------------------------
 // ----------------------------------------------------------------------------
 
-const void_funptr_t PROGMEM _kb_layout_release[KB_LAYERS][KB_ROWS][KB_COLUMNS] = {
-
-	KB_MATRIX_LAYER(  // release: layer 0: default
-// unused
-NULL,
-// left hand
- kprrel, kprrel, kprrel, kprrel, kprrel, kprrel, kprrel,
- kprrel, kprrel, kprrel, kprrel, kprrel, kprrel,   NULL,
- kprrel, kprrel, kprrel, kprrel, kprrel, kprrel,
- s2kcap, kprrel, kprrel, kprrel, kprrel, kprrel,  lpop1,
- kprrel, kprrel, kprrel, kprrel, kprrel,
-                                                 kprrel, kprrel,
-                                           NULL,   NULL, kprrel,
-                                         kprrel, kprrel, kprrel,
-// right hand
-          NULL, kprrel, kprrel, kprrel, kprrel, kprrel, kprrel,
-        kprrel, kprrel, kprrel, kprrel, kprrel, kprrel, kprrel,
-                kprrel, kprrel, kprrel, kprrel, kprrel, kprrel,
-         lpop1, kprrel, kprrel, kprrel, kprrel, kprrel, s2kcap,
-                        kprrel, kprrel, kprrel, kprrel, kprrel,
- kprrel, kprrel,
- kprrel,   NULL,   NULL,
- kprrel, kprrel, kprrel ),
-
-
-	KB_MATRIX_LAYER(  // release: layer 1: function and symbol keys
-// unused
-NULL,
-// left hand
-   NULL, kprrel, kprrel, kprrel, kprrel, kprrel, kprrel,
- ktrans,sshprre,sshprre, kprrel, kprrel,   NULL,   NULL,
- ktrans, kprrel, kprrel, kprrel, kprrel,sshprre,
- ktrans, kprrel, kprrel, kprrel, kprrel,sshprre,  lpop2,
- ktrans, ktrans, ktrans, ktrans, ktrans,
-                                                 ktrans, ktrans,
-                                         ktrans, ktrans, ktrans,
-                                         ktrans, ktrans, ktrans,
-// right hand
-        kprrel, kprrel, kprrel, kprrel, kprrel, kprrel, kprrel,
-        ktrans,   NULL, kprrel,sshprre,sshprre, kprrel, kprrel,
-                kprrel, kprrel,sshprre,sshprre,sshprre, kprrel,
-         lpop2,sshprre, kprrel, kprrel, kprrel, kprrel, kprrel,
-                        ktrans, ktrans, ktrans, ktrans, ktrans,
- ktrans, ktrans,
- ktrans, ktrans, ktrans,
- ktrans, ktrans, ktrans ),
-
-
-	KB_MATRIX_LAYER(  // release: layer 2: keyboard functions
+const uint16_t PROGMEM _kb_layout_base[KB_ROWS][KB_COLUMNS] =
+	KB_MATRIX_LAYER(  // layer 0: default
 // unused
-NULL,
+K(none,0),
 // left hand
-   NULL,   NULL,   NULL,   NULL,   NULL,   NULL,   NULL,
-   NULL,   NULL,   NULL,   NULL,   NULL,   NULL,   NULL,
-   NULL,   NULL,   NULL,   NULL,   NULL,   NULL,
-   NULL,   NULL,   NULL,   NULL,   NULL,   NULL,   NULL,
-   NULL,   NULL,   NULL,   NULL,   NULL,
-                                                   NULL,   NULL,
-                                           NULL,   NULL,   NULL,
-                                           NULL,   NULL,   NULL,
+K(prrel,_equal),     K(prrel,_1),     K(prrel,_2),         K(prrel,_3),      K(prrel,_4),      K(prrel,_5),     K(prrel,_esc),
+K(prrel,_backslash), K(prrel,_Q),     K(prrel,_W),         K(prrel,_E),      K(prrel,_R),      K(prrel,_T),     K(push1,1),
+K(prrel,_tab),       K(prrel,_A),     K(prrel,_S),         K(prrel,_D),      K(prrel,_F),      K(prrel,_G),
+K(2kcap,_shiftL),    K(prrel,_Z),     K(prrel,_X),         K(prrel,_C),      K(prrel,_V),      K(prrel,_B),     K(hold1,1),
+K(prrel,_guiL),      K(prrel,_grave), K(prrel,_backslash), K(prrel,_arrowL), K(prrel,_arrowR),
+                                                                                               K(prrel,_ctrlL), K(prrel,_altL),
+                                                                             K(none,0),        K(none,0),       K(prrel,_home),
+                                                                             K(prrel,_bs),     K(prrel,_del),   K(prrel,_end),
 // right hand
-          NULL,   NULL,   NULL,   NULL,   NULL,   NULL,   NULL,
-          NULL,   NULL,   NULL,   NULL,   NULL,   NULL,   NULL,
-                  NULL,   NULL,   NULL,   NULL,   NULL,   NULL,
-          NULL,   NULL,   NULL,   NULL,   NULL,   NULL,   NULL,
-                          NULL,   NULL,   NULL,   NULL,   NULL,
-   NULL,   NULL,
-   NULL,   NULL,   NULL,
-   NULL,   NULL,   NULL ),
+K(punum,3),         K(prrel,_6),     K(prrel,_7),      K(prrel,_8),      K(prrel,_9),      K(prrel,_0),         K(prrel,_dash),
+K(prrel,_bracketL), K(prrel,_Y),     K(prrel,_U),      K(prrel,_I),      K(prrel,_O),      K(prrel,_P),         K(prrel,_bracketR),
+                    K(prrel,_H),     K(prrel,_J),      K(prrel,_K),      K(prrel,_L),      K(prrel,_semicolon), K(prrel,_quote),
+K(hold1,1),         K(prrel,_N),     K(prrel,_M),      K(prrel,_comma),  K(prrel,_period), K(prrel,_slash),     K(2kcap,_shiftR),
+                                     K(prrel,_arrowL), K(prrel,_arrowD), K(prrel,_arrowU), K(prrel,_arrowR),    K(prrel,_guiR),
+K(prrel,_altR),     K(prrel,_ctrlR),
+K(prrel,_pageU),    K(none,0),       K(none,0),
+K(prrel,_pageD),    K(prrel,_enter), K(prrel,_space) );
 
+// ----------------------------------------------------------------------------
 
-	KB_MATRIX_LAYER(  // release: layer 3: numpad
-// unused
-NULL,
-// left hand
- ktrans, ktrans, ktrans, ktrans, ktrans, ktrans, ktrans,
- ktrans, ktrans, ktrans, ktrans, ktrans, ktrans, ktrans,
- ktrans, ktrans, ktrans, ktrans, ktrans, ktrans,
- ktrans, ktrans, ktrans, ktrans, ktrans, ktrans, ktrans,
- ktrans, kprrel, ktrans, ktrans, ktrans,
-                                                 ktrans, ktrans,
-                                         ktrans, ktrans, ktrans,
-                                         ktrans, ktrans, ktrans,
-// right hand
-          NULL, ktrans,   NULL, kprrel, kprrel, kprrel, ktrans,
-        ktrans, ktrans, kprrel, kprrel, kprrel, kprrel, ktrans,
-                ktrans, kprrel, kprrel, kprrel, kprrel, ktrans,
-        ktrans, ktrans, kprrel, kprrel, kprrel, kprrel, ktrans,
-                        ktrans, ktrans, kprrel, kprrel, ktrans,
- ktrans, ktrans,
- ktrans, ktrans, ktrans,
- ktrans, ktrans, kprrel ),
-
-
-	KB_MATRIX_LAYER(  // release: layer 3: nothing (just making sure unused
-			  // functions don't get compiled out)
-// unused
-NULL,
-// other
- kprrel, lpush8,  lpop8,   NULL,   NULL,   NULL,   NULL,   NULL,
-   ktog, lpush9,  lpop9,   NULL,   NULL,   NULL,   NULL,   NULL,
- ktrans,lpush10, lpop10,   NULL,   NULL,   NULL,   NULL,   NULL,
- lpush1,  lpop1,   NULL,   NULL,   NULL,   NULL,   NULL,   NULL,
- lpush2,  lpop2, dbtldr,   NULL,   NULL,   NULL,   NULL,   NULL,
- lpush3,  lpop3,   NULL,   NULL,   NULL,   NULL,   NULL,   NULL,
- lpush4,  lpop4, s2kcap,   NULL,   NULL,   NULL,   NULL,   NULL,
- lpush5,  lpop5,slpunum,   NULL,   NULL,   NULL,   NULL,   NULL,
- lpush6,  lpop6,slponum,   NULL,   NULL,   NULL,   NULL,   NULL,
- lpush7,  lpop7,   NULL,   NULL,   NULL,   NULL,   NULL,   NULL )
-
+// the other layers: the keys each one overrides, by matrix position (see
+// "../matrix.h"); everything else on them is the last argument to
+// `KB_SPARSE_LAYER()` (below)
+
+#define  LAYER_1(O)  /* layer 1: function and symbol keys */ \
+	O( 0x21, K(prrel,_6_kp)         ) \
+	O( 0x22, K(prrel,_7_kp)         ) \
+	O( 0x23, K(prrel,_8_kp)         ) \
+	O( 0x24, K(prrel,_9_kp)         ) \
+	O( 0x25, K(shprre,_equal)       ) \
+	O( 0x26, K(hold2,2)             ) \
+	O( 0x27, K(hold2,2)             ) \
+	O( 0x28, K(shprre,_8)           ) \
+	O( 0x29, K(prrel,_2_kp)         ) \
+	O( 0x2A, K(prrel,_3_kp)         ) \
+	O( 0x2B, K(prrel,_4_kp)         ) \
+	O( 0x2C, K(prrel,_5_kp)         ) \
+	O( 0x2D, K(prrel,_mute)         ) \
+	O( 0x31, K(prrel,_semicolon)    ) \
+	O( 0x32, K(prrel,_slash)        ) \
+	O( 0x33, K(prrel,_dash)         ) \
+	O( 0x34, K(prrel,_0_kp)         ) \
+	O( 0x35, K(shprre,_semicolon)   ) \
+	O( 0x38, K(prrel,_backslash)    ) \
+	O( 0x39, K(prrel,_1_kp)         ) \
+	O( 0x3A, K(shprre,_9)           ) \
+	O( 0x3B, K(shprre,_0)           ) \
+	O( 0x3C, K(shprre,_equal)       ) \
+	O( 0x3D, K(prrel,_volumeD)      ) \
+	O( 0x41, K(shprre,_bracketL)    ) \
+	O( 0x42, K(shprre,_bracketR)    ) \
+	O( 0x43, K(prrel,_bracketL)     ) \
+	O( 0x44, K(prrel,_bracketR)     ) \
+	O( 0x45, K(none,0)              ) \
+	O( 0x46, K(pop1,1)              ) \
+	O( 0x48, K(none,0)              ) \
+	O( 0x49, K(prrel,_dash)         ) \
+	O( 0x4A, K(shprre,_comma)       ) \
+	O( 0x4B, K(shprre,_period)      ) \
+	O( 0x4C, K(prrel,_currencyUnit) ) \
+	O( 0x4D, K(prrel,_volumeU)      ) \
+	O( 0x50, K(none,0)              ) \
+	O( 0x51, K(prrel,_F1)           ) \
+	O( 0x52, K(prrel,_F2)           ) \
+	O( 0x53, K(prrel,_F3)           ) \
+	O( 0x54, K(prrel,_F4)           ) \
+	O( 0x55, K(prrel,_F5)           ) \
+	O( 0x56, K(prrel,_F11)          ) \
+	O( 0x57, K(prrel,_F12)          ) \
+	O( 0x58, K(prrel,_F6)           ) \
+	O( 0x59, K(prrel,_F7)           ) \
+	O( 0x5A, K(prrel,_F8)           ) \
+	O( 0x5B, K(prrel,_F9)           ) \
+	O( 0x5C, K(prrel,_F10)          ) \
+	O( 0x5D, K(prrel,_power)        )
+
+#define  LAYER_2(O)  /* layer 2: keyboard functions */ \
+	O( 0x50, K(btldr,0) )
+
+#define  LAYER_3(O)  /* layer 3: numpad */ \
+	O( 0x0A, K(prrel,_0_kp)     ) \
+	O( 0x11, K(prrel,_insert)   ) \
+	O( 0x1B, K(prrel,_period)   ) \
+	O( 0x1C, K(prrel,_enter_kp) ) \
+	O( 0x29, K(prrel,_1_kp)     ) \
+	O( 0x2A, K(prrel,_2_kp)     ) \
+	O( 0x2B, K(prrel,_3_kp)     ) \
+	O( 0x2C, K(prrel,_enter_kp) ) \
+	O( 0x39, K(prrel,_4_kp)     ) \
+	O( 0x3A, K(prrel,_5_kp)     ) \
+	O( 0x3B, K(prrel,_6_kp)     ) \
+	O( 0x3C, K(prrel,_add_kp)   ) \
+	O( 0x49, K(prrel,_7_kp)     ) \
+	O( 0x4A, K(prrel,_8_kp)     ) \
+	O( 0x4B, K(prrel,_9_kp)     ) \
+	O( 0x4C, K(prrel,_sub_kp)   ) \
+	O( 0x57, K(ponum,3)         ) \
+	O( 0x59, K(ponum,3)         ) \
+	O( 0x5A, K(prrel,_equal_kp) ) \
+	O( 0x5B, K(prrel,_div_kp)   ) \
+	O( 0x5C, K(prrel,_mul_kp)   )
+
+KB_SPARSE_LAYER_ACTIONS( LAYER_1 );
+KB_SPARSE_LAYER_ACTIONS( LAYER_2 );
+KB_SPARSE_LAYER_ACTIONS( LAYER_3 );
+
+const struct kb_sparse_layer PROGMEM _kb_layout_sparse[KB_LAYERS-1] = {
+	KB_SPARSE_LAYER( LAYER_1, K(trans,0) ),
+	KB_SPARSE_LAYER( LAYER_2, K(none,0) ),
+	KB_SPARSE_LAYER( LAYER_3, K(trans,0) ),
 };
 
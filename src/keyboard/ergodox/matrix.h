@@ -17,6 +17,22 @@
 
 	// --------------------------------------------------------------------
 
+	/* matrix representation
+	 * - the matrix is stored as `uint16_t matrix[KB_ROWS]`: bit `col` of
+	 *   `matrix[row]` is set if the key at (row, col) is pressed
+	 * - `KB_MATRIX_SET()` sets or clears one position
+	 */
+	#if KB_COLUMNS > 16
+		#error "KB_COLUMNS must fit in a `uint16_t` row"
+	#endif
+
+	#define KB_MATRIX_SET(matrix, row, col, pressed)			\
+		( (matrix)[row] = (pressed)					\
+		  ? ( (matrix)[row] |  (uint16_t)(1U<<(col)) )			\
+		  : ( (matrix)[row] & ~(uint16_t)(1U<<(col)) ) )
+
+	// --------------------------------------------------------------------
+
 	/* mapping from spatial position to matrix position
 	 * - spatial position: where the key is spatially, relative to other
 	 *   keys both on the keyboard and in the layout
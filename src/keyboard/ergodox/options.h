@@ -37,4 +37,50 @@
 	#define  MCP23018__DRIVE_ROWS     0
 	#define  MCP23018__DRIVE_COLUMNS  1
 
+	/*
+	 * TEENSY__SETTLE_CYCLES
+	 * - How long (in CPU cycles, at 16 MHz) to wait between driving a
+	 *   row or column low and reading the inputs
+	 * - The inputs have to recover through their (20-50 kOhm) internal
+	 *   pull-ups after the previous column was released, which takes on
+	 *   the order of 1 us (see "controller/teensy-2-0.md")
+	 *
+	 * TEENSY__CONSERVATIVE_DELAYS
+	 * - If set, wait 1 us after *every* pin change instead (including
+	 *   during initialization), and write pins one at a time rather than
+	 *   whole ports at once: the original (slower) behavior
+	 */
+	#define  TEENSY__SETTLE_CYCLES        16
+	#define  TEENSY__CONSERVATIVE_DELAYS  0
+
+	/*
+	 * MCP23018__REPROBE_INTERVAL
+	 * - How often (in ms) to try to initialize the MCP23018 (the left
+	 *   hand) while it's not responding (e.g. while it's unplugged)
+	 * - It's initialized once when first seen, and not again until it
+	 *   stops responding, so this only matters while it's detached
+	 */
+	#define  MCP23018__REPROBE_INTERVAL  250
+
+	/*
+	 * CONTROLLER__PIPELINED_SCAN
+	 * - If set, each MCP23018 column is read in the background (using
+	 *   interrupt driven I2C) while the corresponding Teensy column is
+	 *   scanned, so a scan takes about as long as the MCP23018 half alone,
+	 *   instead of the sum of both halves
+	 * - Requires `TEENSY__DRIVE_COLUMNS` and `MCP23018__DRIVE_COLUMNS`
+	 */
+	#define  CONTROLLER__PIPELINED_SCAN  1
+
+	/*
+	 * CONTROLLER__IDLE_PROBE
+	 * - If set, and no key on a given half was down after the last scan,
+	 *   that half is first checked by driving all of its columns (or
+	 *   rows) low at once, and reading its inputs once.  The full sweep is
+	 *   only done if something reads low.
+	 * - While nothing is pressed, this cuts a scan down to a few port
+	 *   reads on the Teensy, and one short I2C transaction to the MCP23018
+	 */
+	#define  CONTROLLER__IDLE_PROBE  1
+
 #endif
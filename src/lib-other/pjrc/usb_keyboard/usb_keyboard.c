@@ -26,6 +26,7 @@
 
 #define USB_SERIAL_PRIVATE_INCLUDE
 #include "usb_keyboard.h"
+#include "../../../lib/latency.h"
 
 /**************************************************************************
  *
@@ -53,6 +54,22 @@
 // operating systems.
 #define SUPPORT_ENDPOINT_HALT
 
+// Report pressed keys as a bitmap (N-key rollover) on a second interface,
+// once the host has read that interface's report descriptor, while it's
+// using the report protocol.  Until then (and whenever the host, e.g. a
+// BIOS, asks for the boot protocol) the boot keyboard interface (6 keys at
+// once) is used.  If you comment this line out, only the boot keyboard
+// interface is used.
+#define SUPPORT_NKRO
+
+// Add a vendor defined (raw) HID interface, with one IN and one OUT
+// endpoint, for reading diagnostics and writing configuration without
+// going through the keyboard reports (see "lib/telemetry.h").  Enabled
+// in the makefile.
+#if MAKEFILE_RAWHID
+#define SUPPORT_RAWHID
+#endif
+
 
 
 /**************************************************************************
@@ -68,11 +85,46 @@
 #define KEYBOARD_SIZE		8
 #define KEYBOARD_BUFFER		EP_DOUBLE_BUFFER
 
+// report: modifier byte, then 1 bit per usage 0x00..0xDF
+#define KEYBOARD_NKRO_INTERFACE	1
+#define KEYBOARD_NKRO_ENDPOINT	4
+#define KEYBOARD_NKRO_SIZE	32
+#define KEYBOARD_NKRO_BUFFER	EP_DOUBLE_BUFFER
+#define KEYBOARD_NKRO_REPORT_LENGTH	(1+KEYBOARD_NKRO_KEYS)
+
+#ifdef SUPPORT_NKRO
+#define KEYBOARD_REPORT_MAX	KEYBOARD_NKRO_REPORT_LENGTH
+#else
+#define KEYBOARD_REPORT_MAX	KEYBOARD_SIZE
+#endif
+
+// the raw HID interface comes after the keyboard interfaces
+#ifdef SUPPORT_NKRO
+#define RAWHID_INTERFACE	2
+#else
+#define RAWHID_INTERFACE	1
+#endif
+#define RAWHID_TX_ENDPOINT	1
+#define RAWHID_RX_ENDPOINT	2
+#define RAWHID_BUFFER		EP_DOUBLE_BUFFER
+#define RAWHID_USAGE_PAGE	0xFFAB	// vendor defined
+#define RAWHID_USAGE		0x0200
+#define RAWHID_INTERVAL		1	// in ms
+
 static const uint8_t PROGMEM endpoint_config_table[] = {
+#ifdef SUPPORT_RAWHID
+	1, EP_TYPE_INTERRUPT_IN,  EP_SIZE(RAWHID_SIZE) | RAWHID_BUFFER,
+	1, EP_TYPE_INTERRUPT_OUT, EP_SIZE(RAWHID_SIZE) | RAWHID_BUFFER,
+#else
 	0,
 	0,
+#endif
 	1, EP_TYPE_INTERRUPT_IN,  EP_SIZE(KEYBOARD_SIZE) | KEYBOARD_BUFFER,
+#ifdef SUPPORT_NKRO
+	1, EP_TYPE_INTERRUPT_IN,  EP_SIZE(KEYBOARD_NKRO_SIZE) | KEYBOARD_NKRO_BUFFER
+#else
 	0
+#endif
 };
 
 
@@ -142,15 +194,86 @@ static const uint8_t PROGMEM keyboard_hid_report_desc[] = {
         0xc0                 // End Collection
 };
 
-#define CONFIG1_DESC_SIZE        (9+9+9+7)
+#ifdef SUPPORT_NKRO
+// N-key rollover keyboard: modifiers and LEDs as above, then a bitmap of
+// usages 0x00..0xDF
+static const uint8_t PROGMEM keyboard_nkro_hid_report_desc[] = {
+        0x05, 0x01,          // Usage Page (Generic Desktop),
+        0x09, 0x06,          // Usage (Keyboard),
+        0xA1, 0x01,          // Collection (Application),
+        0x75, 0x01,          //   Report Size (1),
+        0x95, 0x08,          //   Report Count (8),
+        0x05, 0x07,          //   Usage Page (Key Codes),
+        0x19, 0xE0,          //   Usage Minimum (224),
+        0x29, 0xE7,          //   Usage Maximum (231),
+        0x15, 0x00,          //   Logical Minimum (0),
+        0x25, 0x01,          //   Logical Maximum (1),
+        0x81, 0x02,          //   Input (Data, Variable, Absolute), ;Modifier byte
+        0x95, 0x05,          //   Report Count (5),
+        0x75, 0x01,          //   Report Size (1),
+        0x05, 0x08,          //   Usage Page (LEDs),
+        0x19, 0x01,          //   Usage Minimum (1),
+        0x29, 0x05,          //   Usage Maximum (5),
+        0x91, 0x02,          //   Output (Data, Variable, Absolute), ;LED report
+        0x95, 0x01,          //   Report Count (1),
+        0x75, 0x03,          //   Report Size (3),
+        0x91, 0x03,          //   Output (Constant),                 ;LED report padding
+        0x95, 0xE0,          //   Report Count (224),
+        0x75, 0x01,          //   Report Size (1),
+        0x15, 0x00,          //   Logical Minimum (0),
+        0x25, 0x01,          //   Logical Maximum (1),
+        0x05, 0x07,          //   Usage Page (Key Codes),
+        0x19, 0x00,          //   Usage Minimum (0),
+        0x29, 0xDF,          //   Usage Maximum (223),
+        0x81, 0x02,          //   Input (Data, Variable, Absolute), ;Key bitmap
+        0xc0                 // End Collection
+};
+#endif
+
+#ifdef SUPPORT_RAWHID
+// vendor defined: RAWHID_SIZE bytes in, and RAWHID_SIZE bytes out
+static const uint8_t PROGMEM rawhid_hid_report_desc[] = {
+        0x06, LSB(RAWHID_USAGE_PAGE), MSB(RAWHID_USAGE_PAGE), // Usage Page (Vendor Defined),
+        0x0A, LSB(RAWHID_USAGE), MSB(RAWHID_USAGE), // Usage (Vendor Defined),
+        0xA1, 0x01,          // Collection (Application),
+        0x75, 0x08,          //   Report Size (8),
+        0x15, 0x00,          //   Logical Minimum (0),
+        0x26, 0xFF, 0x00,    //   Logical Maximum (255),
+        0x95, RAWHID_SIZE,   //   Report Count (RAWHID_SIZE),
+        0x09, 0x01,          //   Usage (Vendor Defined),
+        0x81, 0x02,          //   Input (Data, Variable, Absolute),
+        0x95, RAWHID_SIZE,   //   Report Count (RAWHID_SIZE),
+        0x09, 0x02,          //   Usage (Vendor Defined),
+        0x91, 0x02,          //   Output (Data, Variable, Absolute),
+        0xc0                 // End Collection
+};
+#endif
+
+// descriptor sizes and offsets, by interface
+#ifdef SUPPORT_NKRO
+#define KEYBOARD_INTERFACES      2
+#define KEYBOARD_DESC_SIZE       (9+9+7+9+9+7)
+#else
+#define KEYBOARD_INTERFACES      1
+#define KEYBOARD_DESC_SIZE       (9+9+7)
+#endif
+#ifdef SUPPORT_RAWHID
+#define NUM_INTERFACES           (KEYBOARD_INTERFACES+1)
+#define CONFIG1_DESC_SIZE        (9+KEYBOARD_DESC_SIZE+9+9+7+7)
+#else
+#define NUM_INTERFACES           KEYBOARD_INTERFACES
+#define CONFIG1_DESC_SIZE        (9+KEYBOARD_DESC_SIZE)
+#endif
 #define KEYBOARD_HID_DESC_OFFSET (9+9)
+#define KEYBOARD_NKRO_HID_DESC_OFFSET (9+9+9+7+9)
+#define RAWHID_HID_DESC_OFFSET   (9+KEYBOARD_DESC_SIZE+9)
 static const uint8_t PROGMEM config1_descriptor[CONFIG1_DESC_SIZE] = {
 	// configuration descriptor, USB spec 9.6.3, page 264-266, Table 9-10
 	9, 					// bLength;
 	2,					// bDescriptorType;
 	LSB(CONFIG1_DESC_SIZE),			// wTotalLength
 	MSB(CONFIG1_DESC_SIZE),
-	1,					// bNumInterfaces
+	NUM_INTERFACES,				// bNumInterfaces
 	1,					// bConfigurationValue
 	0,					// iConfiguration
 	0xC0,					// bmAttributes
@@ -180,7 +303,70 @@ static const uint8_t PROGMEM config1_descriptor[CONFIG1_DESC_SIZE] = {
 	KEYBOARD_ENDPOINT | 0x80,		// bEndpointAddress
 	0x03,					// bmAttributes (0x03=intr)
 	KEYBOARD_SIZE, 0,			// wMaxPacketSize
-	1					// bInterval
+	1,					// bInterval
+#ifdef SUPPORT_NKRO
+	// interface descriptor, USB spec 9.6.5, page 267-269, Table 9-12
+	9,					// bLength
+	4,					// bDescriptorType
+	KEYBOARD_NKRO_INTERFACE,		// bInterfaceNumber
+	0,					// bAlternateSetting
+	1,					// bNumEndpoints
+	0x03,					// bInterfaceClass (0x03 = HID)
+	0x00,					// bInterfaceSubClass (0x00 = None)
+	0x00,					// bInterfaceProtocol (0x00 = None)
+	0,					// iInterface
+	// HID interface descriptor, HID 1.11 spec, section 6.2.1
+	9,					// bLength
+	0x21,					// bDescriptorType
+	0x11, 0x01,				// bcdHID
+	0,					// bCountryCode
+	1,					// bNumDescriptors
+	0x22,					// bDescriptorType
+	sizeof(keyboard_nkro_hid_report_desc),	// wDescriptorLength
+	0,
+	// endpoint descriptor, USB spec 9.6.6, page 269-271, Table 9-13
+	7,					// bLength
+	5,					// bDescriptorType
+	KEYBOARD_NKRO_ENDPOINT | 0x80,		// bEndpointAddress
+	0x03,					// bmAttributes (0x03=intr)
+	KEYBOARD_NKRO_SIZE, 0,			// wMaxPacketSize
+	1,					// bInterval
+#endif
+#ifdef SUPPORT_RAWHID
+	// interface descriptor, USB spec 9.6.5, page 267-269, Table 9-12
+	9,					// bLength
+	4,					// bDescriptorType
+	RAWHID_INTERFACE,			// bInterfaceNumber
+	0,					// bAlternateSetting
+	2,					// bNumEndpoints
+	0x03,					// bInterfaceClass (0x03 = HID)
+	0x00,					// bInterfaceSubClass (0x00 = None)
+	0x00,					// bInterfaceProtocol (0x00 = None)
+	0,					// iInterface
+	// HID interface descriptor, HID 1.11 spec, section 6.2.1
+	9,					// bLength
+	0x21,					// bDescriptorType
+	0x11, 0x01,				// bcdHID
+	0,					// bCountryCode
+	1,					// bNumDescriptors
+	0x22,					// bDescriptorType
+	sizeof(rawhid_hid_report_desc),		// wDescriptorLength
+	0,
+	// endpoint descriptor, USB spec 9.6.6, page 269-271, Table 9-13
+	7,					// bLength
+	5,					// bDescriptorType
+	RAWHID_TX_ENDPOINT | 0x80,		// bEndpointAddress
+	0x03,					// bmAttributes (0x03=intr)
+	RAWHID_SIZE, 0,				// wMaxPacketSize
+	RAWHID_INTERVAL,			// bInterval
+	// endpoint descriptor, USB spec 9.6.6, page 269-271, Table 9-13
+	7,					// bLength
+	5,					// bDescriptorType
+	RAWHID_RX_ENDPOINT,			// bEndpointAddress
+	0x03,					// bmAttributes (0x03=intr)
+	RAWHID_SIZE, 0,				// wMaxPacketSize
+	RAWHID_INTERVAL,			// bInterval
+#endif
 };
 
 // If you're desperate for a little extra code memory, these strings
@@ -219,6 +405,14 @@ static struct descriptor_list_struct {
 	{0x0200, 0x0000, config1_descriptor, sizeof(config1_descriptor)},
 	{0x2200, KEYBOARD_INTERFACE, keyboard_hid_report_desc, sizeof(keyboard_hid_report_desc)},
 	{0x2100, KEYBOARD_INTERFACE, config1_descriptor+KEYBOARD_HID_DESC_OFFSET, 9},
+#ifdef SUPPORT_NKRO
+	{0x2200, KEYBOARD_NKRO_INTERFACE, keyboard_nkro_hid_report_desc, sizeof(keyboard_nkro_hid_report_desc)},
+	{0x2100, KEYBOARD_NKRO_INTERFACE, config1_descriptor+KEYBOARD_NKRO_HID_DESC_OFFSET, 9},
+#endif
+#ifdef SUPPORT_RAWHID
+	{0x2200, RAWHID_INTERFACE, rawhid_hid_report_desc, sizeof(rawhid_hid_report_desc)},
+	{0x2100, RAWHID_INTERFACE, config1_descriptor+RAWHID_HID_DESC_OFFSET, 9},
+#endif
 	{0x0300, 0x0000, (const uint8_t *)&string0, 4},
 	{0x0301, 0x0409, (const uint8_t *)&string1, sizeof(STR_MANUFACTURER)},
 	{0x0302, 0x0409, (const uint8_t *)&string2, sizeof(STR_PRODUCT)}
@@ -235,19 +429,54 @@ static struct descriptor_list_struct {
 // zero when we are not configured, non-zero when enumerated
 static volatile uint8_t usb_configuration=0;
 
-// which modifier keys are currently pressed
-// 1=left ctrl,    2=left shift,   4=left alt,    8=left gui
-// 16=right ctrl, 32=right shift, 64=right alt, 128=right gui
-uint8_t keyboard_modifier_keys=0;
-
-// which keys are currently pressed, up to 6 keys may be down at once
-uint8_t keyboard_keys[6]={0,0,0,0,0,0};
-
-// protocol setting from the host.  We use exactly the same report
-// either way, so this variable only stores the setting since we
-// are required to be able to report which setting is in use.
+// which keys are currently pressed, 1 bit per usage (bit (n & 7) of byte
+// (n >> 3) for usage n).  reports (boot or N-key rollover) are built from
+// this when they're queued
+// - the modifier keys (usages 0xE0..0xE7) are byte 28, which is also
+//   `keyboard_modifier_keys` (see the header):
+//   1=left ctrl,    2=left shift,   4=left alt,    8=left gui
+//   16=right ctrl, 32=right shift, 64=right alt, 128=right gui
+uint8_t keyboard_key_bitmap[KEYBOARD_KEY_BITMAP_SIZE];
+
+// reports waiting to be sent, oldest first.  usb_keyboard_send() adds
+// to the queue, and the SOF interrupt sends one report per frame, so
+// that nobody has to wait on the endpoint
+#define KEYBOARD_QUEUE_SIZE	8
+static uint8_t keyboard_queue[KEYBOARD_QUEUE_SIZE][KEYBOARD_REPORT_MAX];
+static uint8_t keyboard_queue_head=0;
+static uint8_t keyboard_queue_length=0;
+
+// the last report queued, so we can skip queueing reports that haven't
+// changed, and so the idle timer has something to resend.  only written
+// with interrupts disabled (the SOF interrupt only reads it)
+static uint8_t keyboard_report_last[KEYBOARD_REPORT_MAX];
+
+// protocol setting from the host (0=boot, 1=report), for the boot
+// keyboard interface.  we use exactly the same report either way on
+// that interface, so this variable only stores the setting since we are
+// required to be able to report which setting is in use.
 static uint8_t keyboard_protocol=1;
 
+#ifdef SUPPORT_NKRO
+// whether the host has read the N-key rollover interface's report
+// descriptor.  a host using the boot protocol (e.g. a BIOS) doesn't read
+// report descriptors, and may not know about the second interface at
+// all, so reports go to the boot interface until this is set (and the
+// protocol is still report)
+static uint8_t keyboard_nkro_enabled=0;
+#endif
+
+// which interface (and report format) is in use
+#ifdef SUPPORT_NKRO
+#define keyboard_nkro_active()		(keyboard_protocol && keyboard_nkro_enabled)
+#else
+#define keyboard_nkro_active()		(0)
+#endif
+#define keyboard_report_endpoint()	(keyboard_nkro_active() ? \
+	KEYBOARD_NKRO_ENDPOINT : KEYBOARD_ENDPOINT)
+#define keyboard_report_length()	(keyboard_nkro_active() ? \
+	KEYBOARD_NKRO_REPORT_LENGTH : KEYBOARD_SIZE)
+
 // the idle configuration, how often we send the report to the
 // host (ms * 4) even when it hasn't changed
 static uint8_t keyboard_idle_config=125;
@@ -288,53 +517,143 @@ uint8_t usb_configured(void)
 }
 
 
-// perform a single keystroke
-int8_t usb_keyboard_press(uint8_t key, uint8_t modifier)
+// the report format may have changed, so start over
+static void keyboard_reports_reset(void)
+{
+	uint8_t i;
+
+	keyboard_queue_length = 0;
+	for (i=0; i<KEYBOARD_REPORT_MAX; i++) {
+		keyboard_report_last[i] = 0;
+	}
+}
+
+// fill in a report with the current state, in the format of the boot
+// (nkro=0) or N-key rollover (nkro=1) interface, and return its length
+// - the boot report lists the first 6 keys pressed (by usage).  if more
+//   are pressed, every slot is ErrorRollOver (0x01), as the HID spec says
+static uint8_t keyboard_fill_report(uint8_t *report, uint8_t nkro)
 {
-	int8_t r;
-
-	keyboard_modifier_keys = modifier;
-	keyboard_keys[0] = key;
-	r = usb_keyboard_send();
-	if (r) return r;
-	keyboard_modifier_keys = 0;
-	keyboard_keys[0] = 0;
-	return usb_keyboard_send();
+	uint8_t i, b, n;
+
+	report[0] = keyboard_modifier_keys;
+	#ifdef SUPPORT_NKRO
+	if (nkro) {
+		for (i=0; i<KEYBOARD_NKRO_KEYS; i++) {
+			report[i+1] = keyboard_key_bitmap[i];
+		}
+		return KEYBOARD_NKRO_REPORT_LENGTH;
+	}
+	#endif
+	report[1] = 0;
+	n = 2;
+	for (i=0; i<KEYBOARD_NKRO_KEYS; i++) {
+		if (!keyboard_key_bitmap[i]) continue;
+		for (b=0; b<8; b++) {
+			if (!(keyboard_key_bitmap[i] & (1<<b))) continue;
+			if (n == KEYBOARD_SIZE) {
+				for (n=2; n<KEYBOARD_SIZE; n++) report[n] = 0x01;
+				return KEYBOARD_SIZE;
+			}
+			report[n++] = (i<<3) | b;
+		}
+	}
+	while (n < KEYBOARD_SIZE) report[n++] = 0;
+	return KEYBOARD_SIZE;
 }
 
-// send the contents of keyboard_keys and keyboard_modifier_keys
+// queue the current state (keyboard_key_bitmap and keyboard_modifier_keys),
+// to be sent by the SOF interrupt
+// - this used to wait (with interrupts disabled, for up to 50 frames)
+//   for the endpoint to be ready.  now it doesn't wait at all.
+// - if the queue is full, the newest report is replaced, so the host
+//   still ends up with the current state
 int8_t usb_keyboard_send(void)
 {
-	uint8_t i, intr_state, timeout;
+	uint8_t i, intr_state, *report;
+
+	if (!usb_configuration) return -1;
+	intr_state = SREG;
+	cli();
+	if (keyboard_queue_length < KEYBOARD_QUEUE_SIZE) keyboard_queue_length++;
+	i = (keyboard_queue_head + keyboard_queue_length - 1) % KEYBOARD_QUEUE_SIZE;
+	report = keyboard_queue[i];
+	#if MAKEFILE_LATENCY_HISTOGRAMS
+	latency_queued(i);
+	#endif
+	keyboard_fill_report(report, keyboard_nkro_active());
+	for (i=0; i<KEYBOARD_REPORT_MAX; i++) {
+		keyboard_report_last[i] = report[i];
+	}
+	SREG = intr_state;
+	return 0;
+}
+
+// queue the current state, but only if it's changed since the last report
+// we queued (the SOF interrupt takes care of resending the report when the
+// host's idle rate says to)
+int8_t usb_keyboard_send_if_changed(void)
+{
+	uint8_t i, len, changed=0, intr_state, report[KEYBOARD_REPORT_MAX];
+
+	intr_state = SREG;
+	cli();
+	len = keyboard_fill_report(report, keyboard_nkro_active());
+	for (i=0; i<len; i++) {
+		if (report[i] != keyboard_report_last[i]) changed = 1;
+	}
+	SREG = intr_state;
+	if (changed) return usb_keyboard_send();
+	return 0;
+}
+
+#ifdef SUPPORT_RAWHID
+// receive a packet from the raw HID interface, if there is one (this
+// doesn't wait).  returns the number of bytes received (RAWHID_SIZE, or
+// 0 if nothing was waiting), or -1 if the USB isn't configured
+int8_t usb_rawhid_recv(uint8_t *buffer)
+{
+	uint8_t i, intr_state;
+
+	if (!usb_configuration) return -1;
+	intr_state = SREG;
+	cli();
+	UENUM = RAWHID_RX_ENDPOINT;
+	if (!(UEINTX & (1<<RWAL))) {
+		SREG = intr_state;
+		return 0;
+	}
+	for (i=0; i<RAWHID_SIZE; i++) {
+		*buffer++ = UEDATX;
+	}
+	UEINTX = 0x6B;	// release the bank
+	SREG = intr_state;
+	return RAWHID_SIZE;
+}
+
+// send a packet on the raw HID interface, if there's room (this doesn't
+// wait).  returns 0 on success, or -1 if the USB isn't configured or the
+// endpoint is busy
+int8_t usb_rawhid_send(const uint8_t *buffer)
+{
+	uint8_t i, intr_state;
 
 	if (!usb_configuration) return -1;
 	intr_state = SREG;
 	cli();
-	UENUM = KEYBOARD_ENDPOINT;
-	timeout = UDFNUML + 50;
-	while (1) {
-		// are we ready to transmit?
-		if (UEINTX & (1<<RWAL)) break;
+	UENUM = RAWHID_TX_ENDPOINT;
+	if (!(UEINTX & (1<<RWAL))) {
 		SREG = intr_state;
-		// has the USB gone offline?
-		if (!usb_configuration) return -1;
-		// have we waited too long?
-		if (UDFNUML == timeout) return -1;
-		// get ready to try checking again
-		intr_state = SREG;
-		cli();
-		UENUM = KEYBOARD_ENDPOINT;
+		return -1;
 	}
-	UEDATX = keyboard_modifier_keys;
-	UEDATX = 0;
-	for (i=0; i<6; i++) {
-		UEDATX = keyboard_keys[i];
+	for (i=0; i<RAWHID_SIZE; i++) {
+		UEDATX = *buffer++;
 	}
 	UEINTX = 0x3A;
-	keyboard_idle_count = 0;
 	SREG = intr_state;
 	return 0;
 }
+#endif
 
 /**************************************************************************
  *
@@ -349,8 +668,8 @@ int8_t usb_keyboard_send(void)
 //
 ISR(USB_GEN_vect)
 {
-	uint8_t intbits, i;  // used to declare a variable `t` as well, but it
-			     //   wasn't used ::Ben Blazak, 2012::
+	uint8_t intbits, i, len;  // used to declare a variable `t` as well,
+				  //   but it wasn't used ::Ben Blazak, 2012::
 	static uint8_t div4=0;
 
         intbits = UDINT;
@@ -362,18 +681,38 @@ ISR(USB_GEN_vect)
 		UECFG1X = EP_SIZE(ENDPOINT0_SIZE) | EP_SINGLE_BUFFER;
 		UEIENX = (1<<RXSTPE);
 		usb_configuration = 0;
+		keyboard_queue_length = 0;
+		keyboard_protocol = 1;
+		#ifdef SUPPORT_NKRO
+		keyboard_nkro_enabled = 0;
+		#endif
         }
 	if ((intbits & (1<<SOFI)) && usb_configuration) {
-		if (keyboard_idle_config && (++div4 & 3) == 0) {
-			UENUM = KEYBOARD_ENDPOINT;
-			if (UEINTX & (1<<RWAL)) {
+		UENUM = keyboard_report_endpoint();
+		len = keyboard_report_length();
+		// send the next queued report, if there's room (one per frame)
+		if (keyboard_queue_length && (UEINTX & (1<<RWAL))) {
+			for (i=0; i<len; i++) {
+				UEDATX = keyboard_queue[keyboard_queue_head][i];
+			}
+			UEINTX = 0x3A;
+			#if MAKEFILE_LATENCY_HISTOGRAMS
+			latency_sent(keyboard_queue_head);
+			#endif
+			keyboard_queue_head = (keyboard_queue_head + 1) % KEYBOARD_QUEUE_SIZE;
+			keyboard_queue_length--;
+			keyboard_idle_count = 0;
+		}
+		// otherwise, resend the last report if the idle rate says to
+		// - the last report, as it was queued, not the current state:
+		//   the main loop may be half way through changing that
+		else if (keyboard_idle_config && (++div4 & 3) == 0) {
+			if (!keyboard_queue_length && (UEINTX & (1<<RWAL))) {
 				keyboard_idle_count++;
 				if (keyboard_idle_count == keyboard_idle_config) {
 					keyboard_idle_count = 0;
-					UEDATX = keyboard_modifier_keys;
-					UEDATX = 0;
-					for (i=0; i<6; i++) {
-						UEDATX = keyboard_keys[i];
+					for (i=0; i<len; i++) {
+						UEDATX = keyboard_report_last[i];
 					}
 					UEINTX = 0x3A;
 				}
@@ -422,6 +761,7 @@ ISR(USB_COM_vect)
 	uint16_t desc_val;
 	const uint8_t *desc_addr;
 	uint8_t	desc_length;
+	uint8_t report[KEYBOARD_REPORT_MAX];
 
         UENUM = 0;
 	intbits = UEINTX;
@@ -459,6 +799,13 @@ ISR(USB_COM_vect)
 				desc_length = pgm_read_byte(list);
 				break;
 			}
+			#ifdef SUPPORT_NKRO
+			if (wValue == 0x2200 && wIndex == KEYBOARD_NKRO_INTERFACE
+			    && !keyboard_nkro_enabled) {
+				keyboard_nkro_enabled = 1;
+				keyboard_reports_reset();
+			}
+			#endif
 			len = (wLength < 256) ? wLength : 255;
 			if (len > desc_length) len = desc_length;
 			do {
@@ -540,14 +887,18 @@ ISR(USB_COM_vect)
 			}
 		}
 		#endif
+		#ifdef SUPPORT_NKRO
+		if (wIndex == KEYBOARD_INTERFACE || wIndex == KEYBOARD_NKRO_INTERFACE) {
+		#else
 		if (wIndex == KEYBOARD_INTERFACE) {
+		#endif
 			if (bmRequestType == 0xA1) {
 				if (bRequest == HID_GET_REPORT) {
+					len = keyboard_fill_report(report,
+						wIndex == KEYBOARD_NKRO_INTERFACE);
 					usb_wait_in_ready();
-					UEDATX = keyboard_modifier_keys;
-					UEDATX = 0;
-					for (i=0; i<6; i++) {
-						UEDATX = keyboard_keys[i];
+					for (i=0; i<len; i++) {
+						UEDATX = report[i];
 					}
 					usb_send_in();
 					return;
@@ -580,7 +931,12 @@ ISR(USB_COM_vect)
 					return;
 				}
 				if (bRequest == HID_SET_PROTOCOL) {
-					keyboard_protocol = wValue;
+					// only the boot interface has a boot
+					// protocol: ignore this for the other
+					if (wIndex == KEYBOARD_INTERFACE) {
+						keyboard_protocol = wValue;
+						keyboard_reports_reset();
+					}
 					usb_send_in();
 					return;
 				}
@@ -6,12 +6,21 @@
 void usb_init(void);			// initialize everything
 uint8_t usb_configured(void);		// is the USB port configured
 
-int8_t usb_keyboard_press(uint8_t key, uint8_t modifier);
 int8_t usb_keyboard_send(void);
-extern uint8_t keyboard_modifier_keys;
-extern uint8_t keyboard_keys[6];
+int8_t usb_keyboard_send_if_changed(void);
+#define KEYBOARD_KEY_BITMAP_SIZE 32  // bytes: 1 bit per usage 0x00..0xFF
+#define KEYBOARD_NKRO_KEYS 28  // bytes of the bitmap in the N-key rollover report (usages 0x00..0xDF)
+extern uint8_t keyboard_key_bitmap[KEYBOARD_KEY_BITMAP_SIZE];
+// the modifier keys are usages 0xE0..0xE7, so they're one byte of the bitmap
+#define keyboard_modifier_keys (keyboard_key_bitmap[0xE0>>3])
 extern volatile uint8_t keyboard_leds;
 
+// the vendor defined (raw) HID interface, if MAKEFILE_RAWHID is set: one
+// packet of RAWHID_SIZE bytes each way
+#define RAWHID_SIZE 32
+int8_t usb_rawhid_recv(uint8_t *buffer);
+int8_t usb_rawhid_send(const uint8_t *buffer);
+
 // This file does not include the HID debug functions, so these empty
 // macros replace them with nothing, so users can compile code that
 // has calls to these functions.
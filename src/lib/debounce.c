@@ -0,0 +1,71 @@
+/* ----------------------------------------------------------------------------
+ * Per-key debouncing : code
+ *
+ * Each key in the matrix gets its own counter, so keys are debounced
+ * independently, and the main loop doesn't have to wait on any of them.
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2026 agent <agent@local>
+ * Released under The MIT License (MIT) (see "license.md")
+ * Project located at <https://github.com/benblazak/ergodox-firmware>
+ * ------------------------------------------------------------------------- */
+
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "../keyboard/matrix.h"
+#include "./debounce.h"
+
+// ----------------------------------------------------------------------------
+
+static uint8_t _counters[KB_ROWS][KB_COLUMNS];
+
+// the keys whose counters are running (1 bit per key, like the matrix)
+static uint16_t _settling[KB_ROWS];
+
+// include the selected algorithm (defines `debounce_key()`)
+#include "./variable-include.h"
+#define INCLUDE EXP_STR( ./debounce/MAKEFILE_DEBOUNCE_ALGORITHM.h )
+#include INCLUDE
+
+// ----------------------------------------------------------------------------
+
+/*
+ * debounce_update()
+ *
+ * Arguments
+ * - 'raw': the matrix, as just read from the hardware
+ * - 'was_pressed': the debounced matrix from the previous scan
+ * - 'is_pressed': where to write the debounced matrix for this scan
+ *
+ * Notes
+ * - A key that reads the same as its debounced state, and whose counter
+ *   isn't running, can't change (with any of the algorithms), so only keys
+ *   that differ or are settling are looked at individually.  Usually that's
+ *   none of them, and each row is just copied.
+ */
+void debounce_update( uint16_t raw[KB_ROWS],
+                      uint16_t was_pressed[KB_ROWS],
+                      uint16_t is_pressed[KB_ROWS] ) {
+	for (uint8_t row=0; row<KB_ROWS; row++) {
+		uint16_t todo = (raw[row] ^ was_pressed[row]) | _settling[row];
+
+		is_pressed[row] = was_pressed[row];
+
+		for (uint8_t col=0; todo; col++, todo >>= 1) {
+			if (!(todo & 1))
+				continue;
+
+			uint16_t bit = (uint16_t)1 << col;
+			KB_MATRIX_SET( is_pressed, row, col,
+			               debounce_key( raw[row] & bit,
+			                             was_pressed[row] & bit,
+			                             &_counters[row][col] ) );
+
+			if (_counters[row][col])
+				_settling[row] |= bit;
+			else
+				_settling[row] &= ~bit;
+		}
+	}
+}
+
@@ -0,0 +1,46 @@
+/* ----------------------------------------------------------------------------
+ * Per-key debouncing : exports
+ *
+ * The algorithm used is selected by modifying a variable in the makefile.
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2026 agent <agent@local>
+ * Released under The MIT License (MIT) (see "license.md")
+ * Project located at <https://github.com/benblazak/ergodox-firmware>
+ * ------------------------------------------------------------------------- */
+
+
+#ifndef LIB__DEBOUNCE_h
+	#define LIB__DEBOUNCE_h
+
+	#include <stdbool.h>
+	#include <stdint.h>
+	#include "../keyboard/matrix.h"
+
+	// --------------------------------------------------------------------
+
+	/*
+	 * DEBOUNCE_SCANS
+	 * - The number of scans a key must be stable for before a change is
+	 *   accepted (or, for "eager" changes, the number of scans to ignore
+	 *   the key for afterwards)
+	 * - Scans happen at a fixed rate (see "scan-timer.h"), so this is
+	 *   just the debounce time converted to scans (rounded up, so it's
+	 *   never shorter).  If the main loop overruns its period, debouncing
+	 *   will take a little longer.
+	 */
+	#define  DEBOUNCE_SCANS  \
+		( ( (MAKEFILE_DEBOUNCE_TIME) * 1UL * (MAKEFILE_SCAN_RATE) + 999 ) \
+		  / 1000 )
+
+	#if DEBOUNCE_SCANS < 1 || DEBOUNCE_SCANS > 255
+		#error "DEBOUNCE_TIME or SCAN_RATE out of range (see the makefile)"
+	#endif
+
+	// --------------------------------------------------------------------
+
+	void debounce_update( uint16_t raw[KB_ROWS],
+	                      uint16_t was_pressed[KB_ROWS],
+	                      uint16_t is_pressed[KB_ROWS] );
+
+#endif
+
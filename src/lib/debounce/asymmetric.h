@@ -0,0 +1,37 @@
+/* ----------------------------------------------------------------------------
+ * Per-key debouncing : asymmetric
+ *
+ * - Report presses on the first sample (like "eager"), and releases only
+ *   after `DEBOUNCE_SCANS` released scans in a row (like "deferred").
+ * - Bounce after a press looks like a short release, which is filtered out,
+ *   and by the time a release is reported the switch has settled, so no
+ *   lockout is needed for the next press.
+ *
+ * Only to be included by "../debounce.c".
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2026 agent <agent@local>
+ * Released under The MIT License (MIT) (see "license.md")
+ * Project located at <https://github.com/benblazak/ergodox-firmware>
+ * ------------------------------------------------------------------------- */
+
+
+static inline bool debounce_key( bool raw,
+                                 bool was_pressed,
+                                 uint8_t * counter ) {
+	if (raw == was_pressed) {
+		*counter = 0;
+		return was_pressed;
+	}
+
+	// press
+	if (raw)
+		return true;
+
+	// release
+	if (++(*counter) < DEBOUNCE_SCANS)
+		return true;
+
+	*counter = 0;
+	return false;
+}
+
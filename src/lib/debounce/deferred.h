@@ -0,0 +1,31 @@
+/* ----------------------------------------------------------------------------
+ * Per-key debouncing : deferred
+ *
+ * - Only report a change after the key has read the same (new) value for
+ *   `DEBOUNCE_SCANS` scans in a row.
+ * - Adds `DEBOUNCE_SCANS` scans of latency in both directions, but rejects
+ *   noise as well as bounce.
+ *
+ * Only to be included by "../debounce.c".
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2026 agent <agent@local>
+ * Released under The MIT License (MIT) (see "license.md")
+ * Project located at <https://github.com/benblazak/ergodox-firmware>
+ * ------------------------------------------------------------------------- */
+
+
+static inline bool debounce_key( bool raw,
+                                 bool was_pressed,
+                                 uint8_t * counter ) {
+	if (raw == was_pressed) {
+		*counter = 0;
+		return was_pressed;
+	}
+
+	if (++(*counter) < DEBOUNCE_SCANS)
+		return was_pressed;
+
+	*counter = 0;
+	return raw;
+}
+
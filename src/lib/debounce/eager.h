@@ -0,0 +1,31 @@
+/* ----------------------------------------------------------------------------
+ * Per-key debouncing : eager
+ *
+ * - Report a change on the very first sample that shows it, then ignore the
+ *   key for `DEBOUNCE_SCANS` scans while it bounces.
+ * - Lowest latency in both directions.  Needs a clean signal between
+ *   presses, since noise on an idle key is reported as a keypress.
+ *
+ * Only to be included by "../debounce.c".
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2026 agent <agent@local>
+ * Released under The MIT License (MIT) (see "license.md")
+ * Project located at <https://github.com/benblazak/ergodox-firmware>
+ * ------------------------------------------------------------------------- */
+
+
+static inline bool debounce_key( bool raw,
+                                 bool was_pressed,
+                                 uint8_t * counter ) {
+	// still settling from the last change
+	if (*counter) {
+		(*counter)--;
+		return was_pressed;
+	}
+
+	if (raw != was_pressed)
+		*counter = DEBOUNCE_SCANS;
+
+	return raw;
+}
+
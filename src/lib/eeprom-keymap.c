@@ -0,0 +1,435 @@
+/* ----------------------------------------------------------------------------
+ * EEPROM keymap : code
+ *
+ * Remaps are kept in RAM (all of them, in a small table), and logged to the
+ * EEPROM as they're made.  The EEPROM is only read when we start up.
+ *
+ * Lookups
+ * - Layer 0, and the layer on top of the stack, are kept in RAM in full, with
+ *   their remaps applied, so looking up a key on either is one read from RAM.
+ * - Other layers are read from flash, after checking the remap table (which
+ *   is only searched if the layer has any remaps).
+ *
+ * The log (wear levelling)
+ * - The EEPROM holds a ring of remap records.  Each write goes to the next
+ *   record after the last one, so writes are spread over the whole ring.
+ * - Bit 7 of each record's layer byte is its 'lap': it's flipped every time
+ *   we go around the ring, so the oldest record (where we write next) is the
+ *   first one whose lap differs from the one before it.  Reading the ring
+ *   from there, newer records override older ones.
+ * - Before we overwrite the oldest record, we check whether it's the only
+ *   one for its key.  If it is, and the key's still remapped, the record is
+ *   written again in place instead (only its lap changes, which is one
+ *   byte, so it's never left unfinished), and the unsaved remaps wait for the
+ *   next one.
+ * - Setting a key back to what it is in flash is written like any other
+ *   remap; the entry is dropped from RAM once that's written.
+ *
+ * Writes (lazy)
+ * - Remaps take effect immediately, in RAM.  `eeprom_keymap_writeback()`
+ *   (called once per scan) writes one byte of one record, and only if the
+ *   EEPROM isn't busy, so the scan never waits on the EEPROM (each byte
+ *   takes about 3.4 ms).
+ * - The first byte written marks the record as unfinished (with an invalid
+ *   layer number, and the new lap), and the layer number is written last;
+ *   so if power is lost in the middle, that record is ignored.
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2026 agent <agent@local>
+ * Released under The MIT License (MIT) (see "license.md")
+ * Project located at <https://github.com/benblazak/ergodox-firmware>
+ * ------------------------------------------------------------------------- */
+
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <avr/eeprom.h>
+#include "../keyboard/layout.h"
+#include "../keyboard/matrix.h"
+#include "../main.h"
+#include "./eeprom-keymap.h"
+
+#if MAKEFILE_EEPROM_KEYMAP
+
+// ----------------------------------------------------------------------------
+
+#if EEPROM_KEYMAP_REMAPS > 32
+	#error "EEPROM_KEYMAP_REMAPS must fit in a `uint32_t` bitmap"
+#endif
+#if EEPROM_KEYMAP_LOG_LENGTH > 255 \
+	|| EEPROM_KEYMAP_LOG_LENGTH <= EEPROM_KEYMAP_REMAPS
+	#error "EEPROM_KEYMAP_LOG_LENGTH out of range"
+#endif
+#if KB_ROWS > 16 || KB_COLUMNS > 16
+	#error "key positions must fit in a byte"
+#endif
+#if KB_LAYERS > 16
+	#error "`_remapped_layers` must have a bit for every layer"
+#endif
+
+// ----------------------------------------------------------------------------
+
+/*
+ * A remap (in RAM, and in the EEPROM)
+ * - 'layer': the layer number (in the EEPROM, bit 7 is the lap)
+ * - 'position': the row in the high nibble, and the column in the low (as in
+ *   "../keyboard/ergodox/layout/default--sparse-matrix-control.h")
+ * - 'action': the key's new action word
+ */
+struct remap {
+	uint8_t  layer;
+	uint8_t  position;
+	uint16_t action;
+};
+
+#define  LAP      0x80
+#define  INVALID  0x7F  // the layer number of erased or unfinished records
+
+#define  POSITION(row, column)  ( (uint8_t) ((row) << 4 | (column)) )
+#define  ROW(position)          ( (position) >> 4 )
+#define  COLUMN(position)       ( (position) & 0xF )
+
+// ----------------------------------------------------------------------------
+
+// erased when the '.eep' file is loaded
+static struct remap EEMEM _log[EEPROM_KEYMAP_LOG_LENGTH] = {
+	[0 ... EEPROM_KEYMAP_LOG_LENGTH-1] = { 0xFF, 0xFF, 0xFFFF } };
+
+static uint8_t _log_head;  // the oldest record (the one to write next)
+static uint8_t _log_lap;   // `LAP` or 0 (for records written this lap)
+
+static struct remap _remaps[EEPROM_KEYMAP_REMAPS];
+static uint8_t      _remaps_count;
+static uint32_t     _remaps_dirty;     // bit 'i' set if `_remaps[i]` is unsaved
+static uint16_t     _remapped_layers;  // bit 'layer' set if it has remaps
+
+static uint16_t _base[KB_ROWS][KB_COLUMNS];    // layer 0
+static uint16_t _active[KB_ROWS][KB_COLUMNS];  // layer `_active_layer`
+static uint8_t  _active_layer;                 // 0 if there isn't one
+
+static struct remap _write;       // the record being written
+static uint8_t      _write_step;  // the byte we're on (0 if not writing)
+
+// ----------------------------------------------------------------------------
+
+/*
+ * Find the remap for a key
+ *
+ * Returns
+ * - success: its index in `_remaps`
+ * - failure: `_remaps_count` (the key isn't remapped)
+ */
+static uint8_t _find(uint8_t layer, uint8_t position) {
+	uint8_t i = 0;
+	for (; i < _remaps_count; i++)
+		if (_remaps[i].layer == layer && _remaps[i].position == position)
+			break;
+
+	return i;
+}
+
+/*
+ * Recompute `_remapped_layers`
+ */
+static void _update_layers(void) {
+	_remapped_layers = 0;
+	for (uint8_t i = 0; i < _remaps_count; i++)
+		_remapped_layers |= (1U << _remaps[i].layer);
+}
+
+/*
+ * Remove `_remaps[i]` (by moving the last one into its place)
+ */
+static void _remove(uint8_t i) {
+	uint8_t last = --_remaps_count;
+
+	_remaps[i] = _remaps[last];
+	if (_remaps_dirty & (1UL << last))
+		_remaps_dirty |= (1UL << i);
+	else
+		_remaps_dirty &= ~(1UL << i);
+	_remaps_dirty &= ~(1UL << last);
+
+	_update_layers();
+}
+
+/*
+ * Fill 'cache' with 'layer' (from flash, with its remaps applied)
+ */
+static void _fill(uint16_t cache[KB_ROWS][KB_COLUMNS], uint8_t layer) {
+	for (uint8_t row = 0; row < KB_ROWS; row++)
+		for (uint8_t col = 0; col < KB_COLUMNS; col++)
+			cache[row][col] = kb_layout_flash_action_get(layer, row, col);
+
+	for (uint8_t i = 0; i < _remaps_count; i++)
+		if (_remaps[i].layer == layer)
+			cache[ ROW(_remaps[i].position) ]
+			     [ COLUMN(_remaps[i].position) ] = _remaps[i].action;
+}
+
+/*
+ * Is there a record for this key other than the oldest one?
+ */
+static bool _superseded(uint8_t layer, uint8_t position) {
+	for (uint8_t i = 0; i < EEPROM_KEYMAP_LOG_LENGTH; i++) {
+		if (i == _log_head)
+			continue;
+		if ( (eeprom_read_byte(&_log[i].layer) & ~LAP) == layer
+		     && eeprom_read_byte(&_log[i].position) == position )
+			return true;
+	}
+
+	return false;
+}
+
+/*
+ * Choose what to write over the oldest record
+ * - If it's the only record for a key that's still remapped: itself, again,
+ *   in the new lap.  The key's newer remap (if it's changed since) is written
+ *   in the next record.
+ * - Otherwise: the next unsaved remap.
+ */
+static void _write_start(void) {
+	struct remap oldest;
+	eeprom_read_block(&oldest, &_log[_log_head], sizeof(oldest));
+	oldest.layer &= ~LAP;
+
+	if ( oldest.layer < KB_LAYERS
+	     && _find(oldest.layer, oldest.position) < _remaps_count
+	     && !_superseded(oldest.layer, oldest.position) ) {
+		_write = oldest;
+		_write_step = 5;  // (the other bytes are already right)
+		return;
+	}
+
+	uint8_t i = __builtin_ctzl(_remaps_dirty);
+	_remaps_dirty &= ~(1UL << i);
+	_write = _remaps[i];
+
+	_write_step = 1;
+}
+
+/*
+ * Finish writing a record (after its last byte)
+ */
+static void _write_finish(void) {
+	if (++_log_head == EEPROM_KEYMAP_LOG_LENGTH) {
+		_log_head = 0;
+		_log_lap ^= LAP;
+	}
+
+	_write_step = 0;
+
+	// drop the key from RAM if it's back to what it is in flash (unless it's
+	// been changed again since)
+	uint8_t i = _find(_write.layer, _write.position);
+	if ( i < _remaps_count
+	     && !(_remaps_dirty & (1UL << i))
+	     && _remaps[i].action == kb_layout_flash_action_get(
+			_write.layer, ROW(_write.position), COLUMN(_write.position) ) )
+		_remove(i);
+}
+
+// ----------------------------------------------------------------------------
+
+/*
+ * init()
+ * - Read the remaps from the EEPROM, and fill the layer 0 cache.  Must be
+ *   called before any keys are looked up.
+ */
+void eeprom_keymap_init(void) {
+	// find the oldest record
+	uint8_t lap = eeprom_read_byte(&_log[0].layer) & LAP;
+
+	_log_head = 0;
+	for (uint8_t i = 1; i < EEPROM_KEYMAP_LOG_LENGTH; i++) {
+		if ((eeprom_read_byte(&_log[i].layer) & LAP) != lap) {
+			_log_head = i;
+			break;
+		}
+	}
+	// (if every record is from the same lap, we're starting a new one)
+	_log_lap = (_log_head) ? lap : lap ^ LAP;
+
+	// read the records, from oldest to newest
+	// - a key that's set back to what it is in flash is dropped right away,
+	//   so that it doesn't take up room that a later one may need
+	// - records that don't fit this layout (e.g. written by another one) are
+	//   skipped
+	uint8_t i = _log_head;
+	do {
+		struct remap record;
+		eeprom_read_block(&record, &_log[i], sizeof(record));
+		record.layer &= ~LAP;
+
+		if ( record.layer < KB_LAYERS
+		     && ROW(record.position) < KB_ROWS
+		     && COLUMN(record.position) < KB_COLUMNS
+		     && kb_action_valid(record.action) ) {
+			uint8_t j = _find(record.layer, record.position);
+
+			if ( record.action == kb_layout_flash_action_get(
+						record.layer,
+						ROW(record.position),
+						COLUMN(record.position) ) ) {
+				if (j < _remaps_count)
+					_remove(j);
+			} else if (j < EEPROM_KEYMAP_REMAPS) {
+				if (j == _remaps_count)
+					_remaps_count++;
+				_remaps[j] = record;
+			}
+		}
+
+		if (++i == EEPROM_KEYMAP_LOG_LENGTH)
+			i = 0;
+	} while (i != _log_head);
+	_update_layers();
+
+	_fill(_base, 0);
+	_active_layer = 0;
+}
+
+/*
+ * action_get()
+ *
+ * Returns
+ * - the action word of the key (with remaps applied)
+ */
+uint16_t eeprom_keymap_action_get( uint8_t layer,
+                                   uint8_t row,
+                                   uint8_t column ) {
+	if (!layer)
+		return _base[row][column];
+	if (layer == _active_layer)
+		return _active[row][column];
+
+	if (_remapped_layers & (1U << layer)) {
+		uint8_t i = _find(layer, POSITION(row, column));
+		if (i < _remaps_count)
+			return _remaps[i].action;
+	}
+
+	return kb_layout_flash_action_get(layer, row, column);
+}
+
+/*
+ * set()
+ * - Remap a key.  Takes effect immediately; it's written to the EEPROM
+ *   later (see `eeprom_keymap_writeback()`).
+ * - Setting a key to what it is in flash un-remaps it.
+ *
+ * Returns
+ * - success: 0
+ * - failure:
+ *   - 1: the layer or position is out of range, or the action isn't valid
+ *     (see `kb_action_valid()`)
+ *   - 2: too many keys are remapped already
+ */
+uint8_t eeprom_keymap_set( uint8_t  layer,
+                           uint8_t  row,
+                           uint8_t  column,
+                           uint16_t action ) {
+	if ( layer >= KB_LAYERS || row >= KB_ROWS || column >= KB_COLUMNS
+	     || !kb_action_valid(action) )
+		return 1;
+
+	uint8_t position = POSITION(row, column);
+	uint8_t i = _find(layer, position);
+
+	if (i == _remaps_count) {
+		if (action == kb_layout_flash_action_get(layer, row, column))
+			return 0;  // nothing to do
+		if (i == EEPROM_KEYMAP_REMAPS)
+			return 2;  // error
+
+		_remaps_count++;
+		_remaps[i].layer    = layer;
+		_remaps[i].position = position;
+		_remapped_layers   |= (1U << layer);
+	} else if ( _remaps[i].action == action
+	            && !(_remaps_dirty & (1UL << i)) ) {
+		return 0;  // nothing to do
+	}
+
+	_remaps[i].action = action;
+	_remaps_dirty |= (1UL << i);
+
+	if (layer == 0)
+		_base[row][column] = action;
+	else if (layer == _active_layer)
+		_active[row][column] = action;
+
+	#if MAKEFILE_KEYMAP_CACHE
+		main_keymap_cache_invalidate();
+	#endif
+
+	return 0;
+}
+
+/*
+ * clear()
+ * - Un-remap every key
+ */
+void eeprom_keymap_clear(void) {
+	for (uint8_t i = 0; i < _remaps_count; i++)
+		eeprom_keymap_set( _remaps[i].layer,
+		                   ROW(_remaps[i].position),
+		                   COLUMN(_remaps[i].position),
+		                   kb_layout_flash_action_get(
+		                       _remaps[i].layer,
+		                       ROW(_remaps[i].position),
+		                       COLUMN(_remaps[i].position) ) );
+}
+
+/*
+ * layer_activate()
+ * - Cache 'layer' (which should be the one on top of the layer stack) in RAM
+ */
+void eeprom_keymap_layer_activate(uint8_t layer) {
+	if (layer == _active_layer)
+		return;
+
+	_active_layer = layer;
+	if (layer)
+		_fill(_active, layer);
+}
+
+/*
+ * writeback()
+ * - Write one byte of the next unsaved remap to the EEPROM, if there is one,
+ *   and the EEPROM isn't busy
+ */
+void eeprom_keymap_writeback(void) {
+	if (!eeprom_is_ready())
+		return;
+
+	if (!_write_step) {
+		if (!_remaps_dirty)
+			return;
+		_write_start();
+	}
+
+	struct remap * record = &_log[_log_head];
+
+	switch (_write_step++) {
+		case 1:  eeprom_update_byte( &record->layer, _log_lap | INVALID );
+		         break;
+		case 2:  eeprom_update_byte( (uint8_t *) &record->action,
+		                             (uint8_t) _write.action );
+		         break;
+		case 3:  eeprom_update_byte( (uint8_t *) &record->action + 1,
+		                             (uint8_t) (_write.action >> 8) );
+		         break;
+		case 4:  eeprom_update_byte( &record->position, _write.position );
+		         break;
+		default: eeprom_update_byte( &record->layer,
+		                             _log_lap | _write.layer );
+		         _write_finish();
+		         break;
+	}
+}
+
+// ----------------------------------------------------------------------------
+
+#endif
+
@@ -0,0 +1,54 @@
+/* ----------------------------------------------------------------------------
+ * EEPROM keymap : exports
+ *
+ * Keys remapped at runtime, kept in the EEPROM (so they survive unplugging)
+ * on top of the layout in flash.  Enabled by modifying a variable in the
+ * makefile.
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2026 agent <agent@local>
+ * Released under The MIT License (MIT) (see "license.md")
+ * Project located at <https://github.com/benblazak/ergodox-firmware>
+ * ------------------------------------------------------------------------- */
+
+
+#ifndef LIB__EEPROM_KEYMAP_h
+	#define LIB__EEPROM_KEYMAP_h
+
+	#include <stdint.h>
+
+	// --------------------------------------------------------------------
+
+	#ifndef MAKEFILE_EEPROM_KEYMAP
+		#define MAKEFILE_EEPROM_KEYMAP 0
+	#endif
+
+	/*
+	 * EEPROM_KEYMAP_REMAPS
+	 * - The most keys that can be remapped at once (on all layers
+	 *   together).  Each takes 4 bytes of RAM.  Must be 32 or less.
+	 *
+	 * EEPROM_KEYMAP_LOG_LENGTH
+	 * - The number of remap records in the EEPROM (4 bytes each).  Every
+	 *   write goes to the next record, round and round, so each cell is
+	 *   written about once every `LOG_LENGTH - REMAPS` remaps (or more
+	 *   seldom, if fewer keys are remapped).
+	 */
+	#define  EEPROM_KEYMAP_REMAPS      32
+	#define  EEPROM_KEYMAP_LOG_LENGTH  128
+
+	// --------------------------------------------------------------------
+
+	void     eeprom_keymap_init           (void);
+	uint16_t eeprom_keymap_action_get     ( uint8_t layer,
+	                                        uint8_t row,
+	                                        uint8_t column );
+	uint8_t  eeprom_keymap_set            ( uint8_t  layer,
+	                                        uint8_t  row,
+	                                        uint8_t  column,
+	                                        uint16_t action );
+	void     eeprom_keymap_clear          (void);
+	void     eeprom_keymap_layer_activate (uint8_t layer);
+	void     eeprom_keymap_writeback      (void);
+
+#endif
+
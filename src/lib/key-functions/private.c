@@ -18,6 +18,23 @@
 
 // ----------------------------------------------------------------------------
 
+#if KEY_LeftControl != 0xE0 || KEY_RightGUI != 0xE7
+	#error "Expecting the modifier keys to be usages 0xE0..0xE7"
+#endif
+
+// ----------------------------------------------------------------------------
+
+/*
+ * How many keys are holding down each keycode (4 bits per keycode, 2 per
+ * byte, saturating at 15)
+ * - So that a keycode held by two keys at once stays pressed until both have
+ *   been released.  Whether a keycode is pressed at all is kept in
+ *   `keyboard_key_bitmap` (which the USB reports are built from).
+ */
+static uint8_t _press_counts[256/2];
+
+// ----------------------------------------------------------------------------
+
 /*
  * Generate a normal keypress or keyrelease
  *
@@ -29,93 +46,45 @@
  * - Because of the way USB does things, what this actually does is either add
  *   or remove 'keycode' from the list of currently pressed keys, to be sent at
  *   the end of the current cycle (see main.c)
+ * - Keys are kept in a bitmap, with 1 bit per keycode.  The report sent to
+ *   the host (boot, or N-key rollover, depending on the protocol the host
+ *   asked for) is built from that when it's queued (see
+ *   "lib-other/pjrc/usb_keyboard/usb_keyboard.c").
  */
 void _kbfun_press_release(bool press, uint8_t keycode) {
 	// no-op
 	if (keycode == 0)
 		return;
 
-	// modifier keys
-	switch (keycode) {
-		case KEY_LeftControl:  (press)
-				       ? (keyboard_modifier_keys |=  (1<<0))
-				       : (keyboard_modifier_keys &= ~(1<<0));
-				       return;
-		case KEY_LeftShift:    (press)
-				       ? (keyboard_modifier_keys |=  (1<<1))
-				       : (keyboard_modifier_keys &= ~(1<<1));
-				       return;
-		case KEY_LeftAlt:      (press)
-				       ? (keyboard_modifier_keys |=  (1<<2))
-				       : (keyboard_modifier_keys &= ~(1<<2));
-				       return;
-		case KEY_LeftGUI:      (press)
-				       ? (keyboard_modifier_keys |=  (1<<3))
-				       : (keyboard_modifier_keys &= ~(1<<3));
-				       return;
-		case KEY_RightControl: (press)
-				       ? (keyboard_modifier_keys |=  (1<<4))
-				       : (keyboard_modifier_keys &= ~(1<<4));
-				       return;
-		case KEY_RightShift:   (press)
-				       ? (keyboard_modifier_keys |=  (1<<5))
-				       : (keyboard_modifier_keys &= ~(1<<5));
-				       return;
-		case KEY_RightAlt:     (press)
-				       ? (keyboard_modifier_keys |=  (1<<6))
-				       : (keyboard_modifier_keys &= ~(1<<6));
-				       return;
-		case KEY_RightGUI:     (press)
-				       ? (keyboard_modifier_keys |=  (1<<7))
-				       : (keyboard_modifier_keys &= ~(1<<7));
-				       return;
-	}
+	// all keys, including modifiers
+	// - the modifiers (`KEY_LeftControl` .. `KEY_RightGUI`) are the usages
+	//   0xE0..0xE7, so their bits are bits 0..7 of `keyboard_modifier_keys`
+	//   (which is byte 0xE0>>3 of the bitmap), in the order the HID report
+	//   wants: no special case needed
+	uint8_t * counts = &_press_counts[keycode>>1];
+	uint8_t   shift  = (keycode & 1) ? 4 : 0;
+	uint8_t   count  = (*counts >> shift) & 0x0F;
 
-	// all others
-	for (uint8_t i=0; i<6; i++) {
-		if (press) {
-			if (keyboard_keys[i] == 0) {
-				keyboard_keys[i] = keycode;
-				return;
-			}
-		} else {
-			if (keyboard_keys[i] == keycode) {
-				keyboard_keys[i] = 0;
-				return;
-			}
-		}
+	if (press) {
+		if (count < 0x0F)
+			count++;
+	} else {
+		if (count)
+			count--;
 	}
+
+	*counts = (*counts & ~(0x0F<<shift)) | (count<<shift);
+
+	(count)
+	? (keyboard_key_bitmap[keycode>>3] |=  (1<<(keycode&7)))
+	: (keyboard_key_bitmap[keycode>>3] &= ~(1<<(keycode&7)));
 }
 
 /*
  * Is the given keycode pressed?
  */
 bool _kbfun_is_pressed(uint8_t keycode) {
-	// modifier keys
-	switch (keycode) {
-		case KEY_LeftControl:  if (keyboard_modifier_keys & (1<<0))
-					       return true;
-		case KEY_LeftShift:    if (keyboard_modifier_keys & (1<<1))
-					       return true;
-		case KEY_LeftAlt:      if (keyboard_modifier_keys & (1<<2))
-					       return true;
-		case KEY_LeftGUI:      if (keyboard_modifier_keys & (1<<3))
-					       return true;
-		case KEY_RightControl: if (keyboard_modifier_keys & (1<<4))
-					       return true;
-		case KEY_RightShift:   if (keyboard_modifier_keys & (1<<5))
-					       return true;
-		case KEY_RightAlt:     if (keyboard_modifier_keys & (1<<6))
-					       return true;
-		case KEY_RightGUI:     if (keyboard_modifier_keys & (1<<7))
-					       return true;
-	}
-
-	// all others
-	for (uint8_t i=0; i<6; i++)
-		if (keyboard_keys[i] == keycode)
-			return true;
-
-	return false;
+	// all keys, including modifiers (see `_kbfun_press_release()`)
+	return keyboard_key_bitmap[keycode>>3] & (1<<(keycode&7));
 }
 
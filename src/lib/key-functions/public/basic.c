@@ -23,6 +23,7 @@
 #define  LAYER_OFFSET  main_arg_layer_offset
 #define  ROW           main_arg_row
 #define  COL           main_arg_col
+#define  KEYCODE       main_arg_keycode
 #define  IS_PRESSED    main_arg_is_pressed
 #define  WAS_PRESSED   main_arg_was_pressed
 
@@ -36,7 +37,7 @@
  *   Generate a normal keypress or keyrelease
  */
 void kbfun_press_release(void) {
-	uint8_t keycode = kb_layout_get(LAYER, ROW, COL);
+	uint8_t keycode = KEYCODE;
 	_kbfun_press_release(IS_PRESSED, keycode);
 }
 
@@ -48,7 +49,7 @@ void kbfun_press_release(void) {
  *   Toggle the key pressed or unpressed
  */
 void kbfun_toggle(void) {
-	uint8_t keycode = kb_layout_get(LAYER, ROW, COL);
+	uint8_t keycode = KEYCODE;
 
 	if (_kbfun_is_pressed(keycode))
 		_kbfun_press_release(false, keycode);
@@ -79,7 +80,7 @@ void kbfun_transparent(void) {
 static layer_ids[MAX_LAYER_PUSH_POP_FUNCTIONS];
 
 static void layer_push(uint8_t local_id) {
-	uint8_t keycode = kb_layout_get(LAYER, ROW, COL);
+	uint8_t keycode = KEYCODE;
 	main_layers_pop_id(layer_ids[local_id]);
 	layer_ids[local_id] = main_layers_push(keycode);
 }
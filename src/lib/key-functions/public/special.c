@@ -23,6 +23,7 @@
 #define  LAYER_OFFSET  main_arg_layer_offset
 #define  ROW           main_arg_row
 #define  COL           main_arg_col
+#define  KEYCODE       main_arg_keycode
 #define  IS_PRESSED    main_arg_is_pressed
 #define  WAS_PRESSED   main_arg_was_pressed
 
@@ -43,27 +44,45 @@ void kbfun_shift_press_release(void) {
 	kbfun_press_release();
 }
 
+/*
+ * Release 'keycode' until it's up, and return how many times that took (how
+ * many keys were holding it down)
+ */
+static inline uint8_t release_all(uint8_t keycode) {
+	uint8_t count = 0;
+	for (; _kbfun_is_pressed(keycode); count++)
+		_kbfun_press_release(false, keycode);
+	return count;
+}
+
 /*
  * [name]
  *   Two keys => capslock
  *
  * [description]
  *   When assigned to two keys (e.g. the physical left and right shift keys)
- *   (in both the press and release matrices), pressing and holding down one of
- *   the keys will make the second key toggle capslock
+ *   (with an action that calls it on both press and release), pressing and
+ *   holding down one of the keys will make the second key toggle capslock
  *
  * [note]
  *   If either of the shifts are pressed when the second key is pressed, they
  *   wil be released so that capslock will register properly when pressed.
  *   Capslock will then be pressed and released, and the original state of the
  *   shifts will be restored
+ *
+ * [note]
+ *   A shift can be held down by more than one key at once (e.g. by both of
+ *   ours, if they're assigned to a shift), and stays pressed until all of them
+ *   have released it (see `_kbfun_press_release()`).  So each shift is
+ *   released as many times as it's held, and then pressed that many times
+ *   again.
  */
 void kbfun_2_keys_capslock_press_release(void) {
 	static uint8_t keys_pressed;
-	static bool lshift_pressed;
-	static bool rshift_pressed;
+	uint8_t lshift_count;
+	uint8_t rshift_count;
 
-	uint8_t keycode = kb_layout_get(LAYER, ROW, COL);
+	uint8_t keycode = KEYCODE;
 
 	if (!IS_PRESSED) keys_pressed--;
 
@@ -72,23 +91,22 @@ void kbfun_2_keys_capslock_press_release(void) {
 
 	// take care of capslock (only on the press of the 2nd key)
 	if (keys_pressed == 1 && IS_PRESSED) {
-		// save the state of left and right shift
-		lshift_pressed = _kbfun_is_pressed(KEY_LeftShift);
-		rshift_pressed = _kbfun_is_pressed(KEY_RightShift);
-		// disable both
-		_kbfun_press_release(false, KEY_LeftShift);
-		_kbfun_press_release(false, KEY_RightShift);
+		// save the state of left and right shift, and disable both
+		lshift_count = release_all(KEY_LeftShift);
+		rshift_count = release_all(KEY_RightShift);
 
 		// press capslock, then release it
+		// - each `usb_keyboard_send()` only queues a report; they're sent
+		//   in order, one per USB frame
 		_kbfun_press_release(true, KEY_CapsLock);
 		usb_keyboard_send();
 		_kbfun_press_release(false, KEY_CapsLock);
 		usb_keyboard_send();
 
 		// restore the state of left and right shift
-		if (lshift_pressed)
+		for (; lshift_count; lshift_count--)
 			_kbfun_press_release(true, KEY_LeftShift);
-		if (rshift_pressed)
+		for (; rshift_count; rshift_count--)
 			_kbfun_press_release(true, KEY_RightShift);
 	}
 
@@ -122,7 +140,7 @@ static inline void numpad_toggle_numlock(void) {
  *   key
  */
 void kbfun_layer_push_numpad(void) {
-	uint8_t keycode = kb_layout_get(LAYER, ROW, COL);
+	uint8_t keycode = KEYCODE;
 	main_layers_pop_id(numpad_layer_id);
 	numpad_layer_id = main_layers_push(keycode);
 	numpad_toggle_numlock();
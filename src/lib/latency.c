@@ -0,0 +1,164 @@
+/* ----------------------------------------------------------------------------
+ * Key latency histograms : code
+ *
+ * One change is followed at a time, from the scan in which it was first seen
+ * until the report it ended up in was written to the USB endpoint (the
+ * moment the endpoint accepted it; the host picks it up on its next poll).
+ * Changes that happen while another is being followed (e.g. the rest of a
+ * chord) aren't measured separately, since the report that carries the first
+ * will usually carry them too.
+ *
+ * Probe points:
+ * - `latency_seen()`: `kb_update_matrix()`, when a raw (not yet debounced)
+ *   key state changes; 'when' is the start of that scan
+ * - `latency_dispatched()`: the first key function called after that (in
+ *   `main_exec_key()`, or from the keymap cache)
+ * - `latency_queued()`: `usb_keyboard_send()`, when the next report is
+ *   queued
+ * - `latency_sent()`: the USB SOF interrupt, when that report is written to
+ *   the endpoint
+ *
+ * If a change doesn't make it all the way (it was bounce, or its key didn't
+ * change the report) another one is followed instead, the next time
+ * something is seen.  If its report was queued but never sent (e.g. because
+ * the host reset the bus), it's counted in `latency_dropped`.
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2026 agent <agent@local>
+ * Released under The MIT License (MIT) (see "license.md")
+ * Project located at <https://github.com/benblazak/ergodox-firmware>
+ * ------------------------------------------------------------------------- */
+
+
+#include <stdint.h>
+#include <avr/interrupt.h>
+#include "./time.h"
+#include "./latency.h"
+
+#if MAKEFILE_LATENCY_HISTOGRAMS
+
+// ----------------------------------------------------------------------------
+
+// a change not sent this long after it was seen won't be (100 ms)
+#define  STALE_CYCLES  ( (uint32_t) F_CPU / 10 )
+
+// ----------------------------------------------------------------------------
+
+uint16_t latency_histograms[LATENCY_STAGES][LATENCY_BUCKETS+1];
+uint16_t latency_dropped;
+
+// ----------------------------------------------------------------------------
+
+// how far along the change we're following is
+static volatile enum {
+	IDLE,
+	SEEN,
+	DISPATCHED,
+	QUEUED,
+} _state;
+
+static uint32_t _seen;        // in cycles (see "time.h")
+static uint32_t _dispatched;  // in cycles
+static uint8_t  _slot;        // in the USB report queue
+
+// ----------------------------------------------------------------------------
+
+/*
+ * Add 'cycles' to histogram 'stage'
+ */
+static void _record(uint8_t stage, uint32_t cycles) {
+	uint32_t bucket = cycles >> LATENCY_BUCKET_SHIFT;
+	if (bucket > LATENCY_BUCKETS)
+		bucket = LATENCY_BUCKETS;
+
+	uint16_t * count = &latency_histograms[stage][bucket];
+	if (*count != 0xFFFF)
+		(*count)++;
+}
+
+// ----------------------------------------------------------------------------
+
+/*
+ * seen()
+ * - A raw key state changed, in the scan that started at 'when' (in cycles).
+ *   Start following it, unless we're already following one.
+ */
+void latency_seen(uint32_t when) {
+	uint8_t sreg = SREG;
+	cli();
+
+	if (_state == SEEN || _state == QUEUED) {
+		if (when - _seen < STALE_CYCLES)
+			goto out;
+		if (_state == QUEUED && latency_dropped != 0xFFFF)
+			latency_dropped++;
+	}
+
+	_seen  = when;
+	_state = SEEN;
+
+out:
+	SREG = sreg;
+}
+
+/*
+ * dispatched()
+ * - A key function is about to be called.
+ */
+void latency_dispatched(void) {
+	if (_state != SEEN)
+		return;
+
+	_dispatched = time_cycles();
+	_record(LATENCY_SEEN_TO_DISPATCHED, _dispatched - _seen);
+	_state = DISPATCHED;
+}
+
+/*
+ * queued()
+ * - A report was put in USB report queue slot 'slot'.  Called with
+ *   interrupts disabled.
+ */
+void latency_queued(uint8_t slot) {
+	if (_state != DISPATCHED)
+		return;
+
+	_slot  = slot;
+	_state = QUEUED;
+}
+
+/*
+ * sent()
+ * - The report in USB report queue slot 'slot' was written to the endpoint.
+ *   Called from the SOF interrupt.
+ */
+void latency_sent(uint8_t slot) {
+	if (_state != QUEUED || slot != _slot)
+		return;
+
+	uint32_t now = time_cycles();
+	_record(LATENCY_DISPATCHED_TO_SENT, now - _dispatched);
+	_record(LATENCY_SEEN_TO_SENT,       now - _seen);
+	_state = IDLE;
+}
+
+/*
+ * clear()
+ * - Empty all the histograms (e.g. before a test).
+ */
+void latency_clear(void) {
+	uint8_t sreg = SREG;
+	cli();
+
+	for (uint8_t s=0; s<LATENCY_STAGES; s++)
+		for (uint8_t b=0; b<=LATENCY_BUCKETS; b++)
+			latency_histograms[s][b] = 0;
+	latency_dropped = 0;
+	_state = IDLE;
+
+	SREG = sreg;
+}
+
+// ----------------------------------------------------------------------------
+
+#endif
+
@@ -0,0 +1,60 @@
+/* ----------------------------------------------------------------------------
+ * Key latency histograms : exports
+ *
+ * How long it takes a key change to get from the matrix to the host, measured
+ * on the keyboard (with "time.h"), in 3 stages, and kept in fixed-bucket
+ * histograms in RAM.  Enabled by modifying a variable in the makefile.
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2026 agent <agent@local>
+ * Released under The MIT License (MIT) (see "license.md")
+ * Project located at <https://github.com/benblazak/ergodox-firmware>
+ * ------------------------------------------------------------------------- */
+
+
+#ifndef LIB__LATENCY_h
+	#define LIB__LATENCY_h
+
+	#include <stdint.h>
+
+	// --------------------------------------------------------------------
+
+	#ifndef MAKEFILE_LATENCY_HISTOGRAMS
+		#define MAKEFILE_LATENCY_HISTOGRAMS 0
+	#endif
+
+	/*
+	 * LATENCY_BUCKETS
+	 * - The number of buckets in each histogram (plus one more, at the
+	 *   end, for everything longer).
+	 *
+	 * LATENCY_BUCKET_SHIFT
+	 * - Each bucket is `2^LATENCY_BUCKET_SHIFT` cycles wide (512 μs, at
+	 *   16 MHz), so finding the bucket is a shift instead of a division.
+	 */
+	#define  LATENCY_BUCKETS       16
+	#define  LATENCY_BUCKET_SHIFT  13
+
+	// --------------------------------------------------------------------
+
+	// the histograms (the first index into `latency_histograms`)
+	enum latency_stages {
+		LATENCY_SEEN_TO_DISPATCHED,  // matrix read -> key function called
+		LATENCY_DISPATCHED_TO_SENT,  // key function called -> report sent
+		LATENCY_SEEN_TO_SENT,        // matrix read -> report sent
+		LATENCY_STAGES
+	};
+
+	// counts saturate (at 0xFFFF), instead of wrapping
+	extern uint16_t latency_histograms[LATENCY_STAGES][LATENCY_BUCKETS+1];
+	extern uint16_t latency_dropped;  // reports queued, but never sent
+
+	// --------------------------------------------------------------------
+
+	void latency_seen       (uint32_t when);
+	void latency_dispatched (void);
+	void latency_queued     (uint8_t slot);
+	void latency_sent       (uint8_t slot);
+	void latency_clear      (void);
+
+#endif
+
@@ -0,0 +1,52 @@
+/* ----------------------------------------------------------------------------
+ * Cycle profiler : code
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2026 agent <agent@local>
+ * Released under The MIT License (MIT) (see "license.md")
+ * Project located at <https://github.com/benblazak/ergodox-firmware>
+ * ------------------------------------------------------------------------- */
+
+
+#include <stdint.h>
+#include "./profile.h"
+
+#if MAKEFILE_PROFILE
+
+// ----------------------------------------------------------------------------
+
+struct profile_region profile_regions[PROFILE_REGIONS];
+
+// ----------------------------------------------------------------------------
+
+/*
+ * record()
+ * - Count one run of 'region', that took 'cycles'.
+ */
+void profile_record(uint8_t region, uint32_t cycles) {
+	struct profile_region * r = &profile_regions[region];
+
+	if (r->runs == 0xFFFF)
+		return;  // full (see `profile_clear()`)
+
+	if (r->runs == 0 || cycles < r->cycles_min)
+		r->cycles_min = cycles;
+	if (cycles > r->cycles_max)
+		r->cycles_max = cycles;
+
+	r->cycles_total += cycles;
+	r->runs++;
+}
+
+/*
+ * clear()
+ * - Start over, for every region.
+ */
+void profile_clear(void) {
+	for (uint8_t i=0; i<PROFILE_REGIONS; i++)
+		profile_regions[i] = (struct profile_region) {0};
+}
+
+// ----------------------------------------------------------------------------
+
+#endif
+
@@ -0,0 +1,104 @@
+/* ----------------------------------------------------------------------------
+ * Cycle profiler : exports
+ *
+ * Min, max, and mean cycle counts for named regions of the main loop,
+ * measured with "time.h".  Enabled by modifying a variable in the makefile;
+ * when it's disabled, the macros below compile to nothing.
+ *
+ * Usage
+ * - For a region that runs straight through:
+ *
+ *       PROFILE_BEGIN(DISPATCH);
+ *       ...
+ *       PROFILE_END(DISPATCH);
+ *
+ * - For a region that's split up (e.g. interleaved with another), declare
+ *   its counter, add each piece with `PROFILE_START()` and `PROFILE_STOP()`,
+ *   and then record the total with `PROFILE_RECORD()`.  `PROFILE_EXCLUDE()`
+ *   takes the pieces of one region out of another one that encloses them.
+ *
+ * Notes
+ * - Each `PROFILE_BEGIN()` / `PROFILE_END()` pair costs about 100 cycles
+ *   itself (reading the clock, and recording), some of which is counted in
+ *   the region.
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2026 agent <agent@local>
+ * Released under The MIT License (MIT) (see "license.md")
+ * Project located at <https://github.com/benblazak/ergodox-firmware>
+ * ------------------------------------------------------------------------- */
+
+
+#ifndef LIB__PROFILE_h
+	#define LIB__PROFILE_h
+
+	#include <stdint.h>
+
+	// --------------------------------------------------------------------
+
+	#ifndef MAKEFILE_PROFILE
+		#define MAKEFILE_PROFILE 0
+	#endif
+
+	// --------------------------------------------------------------------
+
+	// the regions (the index into `profile_regions`)
+	enum profile_regions {
+		PROFILE_TEENSY_SCAN,    // the Teensy half of the matrix
+		PROFILE_MCP23018_SCAN,  // the MCP23018 half (including I2C waits)
+		PROFILE_CHANGES,        // debouncing, and finding what changed
+		PROFILE_DISPATCH,       // key functions, and software timers
+		PROFILE_USB_SEND,       // building and queueing the report
+		PROFILE_LEDS,           // updating the LEDs
+		PROFILE_REGIONS
+	};
+
+	struct profile_region {
+		uint16_t runs;          // saturates (and then nothing is recorded)
+		uint32_t cycles_min;
+		uint32_t cycles_max;
+		uint32_t cycles_total;  // over all runs (for the mean)
+	};
+
+	extern struct profile_region profile_regions[PROFILE_REGIONS];
+
+	// --------------------------------------------------------------------
+
+	void profile_record (uint8_t region, uint32_t cycles);
+	void profile_clear  (void);
+
+	// --------------------------------------------------------------------
+
+	#if MAKEFILE_PROFILE
+
+		#include "./time.h"
+
+		#define  PROFILE_DECLARE(region)  \
+			uint32_t _profile__##region = 0
+		#define  PROFILE_START(region)  \
+			_profile__##region -= time_cycles()
+		#define  PROFILE_STOP(region)  \
+			_profile__##region += time_cycles()
+		#define  PROFILE_EXCLUDE(region, other)  \
+			_profile__##region -= _profile__##other
+		#define  PROFILE_RECORD(region)  \
+			profile_record(PROFILE_##region, _profile__##region)
+
+	#else
+
+		#define  PROFILE_DECLARE(region)
+		#define  PROFILE_START(region)
+		#define  PROFILE_STOP(region)
+		#define  PROFILE_EXCLUDE(region, other)
+		#define  PROFILE_RECORD(region)
+
+	#endif
+
+	#define  PROFILE_BEGIN(region)  \
+		PROFILE_DECLARE(region);  \
+		PROFILE_START(region)
+	#define  PROFILE_END(region)  \
+		PROFILE_STOP(region);  \
+		PROFILE_RECORD(region)
+
+#endif
+
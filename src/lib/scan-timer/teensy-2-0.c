@@ -0,0 +1,137 @@
+/* ----------------------------------------------------------------------------
+ * Fixed rate scan timer : Teensy 2.0 : code
+ *
+ * - Timer0 is run in CTC mode, and its compare match interrupt marks the
+ *   start of each scan period.  The main loop sleeps until then, so samples
+ *   are taken at a fixed rate no matter how long the rest of the loop takes
+ *   (as long as it takes less than one period).
+ * - Timer1 is used for the LED PWM (see "keyboard/ergodox/controller").
+ * - See the datasheet, section 13 ("8-bit Timer/Counter0 with PWM").
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2026 agent <agent@local>
+ * Released under The MIT License (MIT) (see "license.md")
+ * Project located at <https://github.com/benblazak/ergodox-firmware>
+ * ------------------------------------------------------------------------- */
+
+
+// ----------------------------------------------------------------------------
+// conditional compile
+#if MAKEFILE_BOARD == teensy-2-0
+// ----------------------------------------------------------------------------
+
+
+#include <stdint.h>
+#include <avr/interrupt.h>
+#include <avr/io.h>
+#include <avr/sleep.h>
+#include "./teensy-2-0.h"
+
+// ----------------------------------------------------------------------------
+
+// timer clock, at 16 MHz
+// - F_CPU / 64 (250 kHz, or 4 μs per count) for 1000 Hz and up
+// - F_CPU / 256 (62.5 kHz, or 16 μs per count) below that
+#if SCAN_TIMER_RATE >= 1000
+	#define  PRESCALE      64
+	#define  CLOCK_SELECT  ( (1<<CS01)|(1<<CS00) )
+#else
+	#define  PRESCALE      256
+	#define  CLOCK_SELECT  ( (1<<CS02) )
+#endif
+#define  TIMER_CLOCK   (F_CPU / PRESCALE)
+#define  TIMER_TOP     (TIMER_CLOCK / SCAN_TIMER_RATE - 1)
+#define  US_PER_COUNT  (1000000 / TIMER_CLOCK)
+
+#if SCAN_TIMER_RATE < 250 || SCAN_TIMER_RATE > 8000
+	#error "SCAN_RATE out of range (see the makefile)"
+#endif
+#if TIMER_TOP > 0xFF
+	#error "Timer0 can't count that high; use a larger prescaler"
+#endif
+
+// ----------------------------------------------------------------------------
+
+uint16_t scan_timer_rate;
+uint16_t scan_timer_jitter_max;
+uint16_t scan_timer_overruns;
+
+static volatile uint8_t _ticks;  // ticks since the last `scan_timer_wait()`
+
+// for the once-per-second statistics
+static uint16_t _window_ticks;
+static uint16_t _window_scans;
+static uint16_t _window_jitter_max;  // in counts
+
+// ----------------------------------------------------------------------------
+
+ISR(TIMER0_COMPA_vect) {
+	_ticks++;
+}
+
+// ----------------------------------------------------------------------------
+
+void scan_timer_init(void) {
+	TCCR0A = (1<<WGM01);             // CTC mode (TOP = OCR0A)
+	TCCR0B = CLOCK_SELECT;           // clock select: F_CPU/PRESCALE
+	OCR0A  = TIMER_TOP;
+	TIMSK0 = (1<<OCIE0A);            // enable compare match A interrupt
+
+	set_sleep_mode(SLEEP_MODE_IDLE); // timer and USB interrupts wake us
+}
+
+/*
+ * wait()
+ * - Sleep until the start of the next scan period
+ *
+ * Returns
+ * - the number of ticks since the last call (1, unless the last pass through
+ *   the main loop took longer than a period, in which case the difference is
+ *   added to `scan_timer_overruns`)
+ */
+uint8_t scan_timer_wait(void) {
+	uint8_t  ticks;
+	uint16_t jitter;
+
+	// sleep until the ISR has run at least once (interrupts are disabled
+	// between checking `_ticks` and sleeping, so we can't miss it)
+	for (;;) {
+		cli();
+		ticks = _ticks;
+		if (ticks)
+			break;
+		sleep_enable();
+		sei();
+		sleep_cpu();
+		sleep_disable();
+	}
+	_ticks = 0;
+	jitter = TCNT0;  // counts since the last compare match
+	sei();
+
+	// statistics
+	// - If we overran, the scan this period should have started at was
+	//   `ticks - 1` periods before the last compare match.  (At most
+	//   255 * 256 + 255 counts, so this can't overflow.)
+	jitter += (uint16_t)(ticks - 1) * (TIMER_TOP + 1);
+	scan_timer_overruns += ticks - 1;
+	if (jitter > _window_jitter_max)
+		_window_jitter_max = jitter;
+	_window_scans++;
+	_window_ticks += ticks;
+	if (_window_ticks >= SCAN_TIMER_RATE) {
+		scan_timer_rate = _window_scans;
+		uint32_t jitter_us = (uint32_t)_window_jitter_max * US_PER_COUNT;
+		scan_timer_jitter_max = (jitter_us > 0xFFFF) ? 0xFFFF : jitter_us;
+		_window_ticks = 0;
+		_window_scans = 0;
+		_window_jitter_max = 0;
+	}
+
+	return ticks;
+}
+
+
+// ----------------------------------------------------------------------------
+#endif
+// ----------------------------------------------------------------------------
+
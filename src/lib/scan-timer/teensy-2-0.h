@@ -0,0 +1,35 @@
+/* ----------------------------------------------------------------------------
+ * Fixed rate scan timer : Teensy 2.0 : exports
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2026 agent <agent@local>
+ * Released under The MIT License (MIT) (see "license.md")
+ * Project located at <https://github.com/benblazak/ergodox-firmware>
+ * ------------------------------------------------------------------------- */
+
+
+#ifndef SCAN_TIMER_h
+	#define SCAN_TIMER_h
+
+	#include <stdint.h>
+
+	// --------------------------------------------------------------------
+
+	#define  SCAN_TIMER_RATE  (MAKEFILE_SCAN_RATE)  // in Hz
+
+	// --------------------------------------------------------------------
+
+	// updated once per second (every `SCAN_TIMER_RATE` ticks)
+	extern uint16_t scan_timer_rate;        // scans in the last second
+	extern uint16_t scan_timer_jitter_max;  // in μs, over the last second
+						// (how late a scan started,
+						// counting missed periods)
+	// running total
+	extern uint16_t scan_timer_overruns;    // ticks missed
+
+	// --------------------------------------------------------------------
+
+	void    scan_timer_init (void);
+	uint8_t scan_timer_wait (void);
+
+#endif
+
@@ -0,0 +1,135 @@
+/* ----------------------------------------------------------------------------
+ * Task scheduler : code
+ *
+ * Tasks are kept in a table, in order of priority (index 0 first).  Each has
+ * a ready flag (a bit in `_ready`).  `scheduler_run()` is called once at the
+ * start of every scan period, and runs the highest priority ready task (to
+ * completion), then looks again, until nothing is ready.  So a task that
+ * becomes ready (e.g. because a task before it made it so) runs before
+ * anything of lower priority, and scanning and reporting never wait behind
+ * cosmetic work that was ready first.
+ *
+ * Cycle budgets:
+ * - Every run is timed (see "time.h").  A run that takes longer than the
+ *   task's budget is counted as an overrun.
+ * - A task with a budget is put off (and stays ready) if there aren't enough
+ *   cycles left in this scan period to run it, so it can't make the next scan
+ *   late.  Nothing after it runs either (this period), so order is kept.  A
+ *   task is never put off twice in a row, so it can't starve.
+ * - Tasks with a budget of 0 are never put off; they should come first in
+ *   the table.
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2026 agent <agent@local>
+ * Released under The MIT License (MIT) (see "license.md")
+ * Project located at <https://github.com/benblazak/ergodox-firmware>
+ * ------------------------------------------------------------------------- */
+
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <avr/interrupt.h>
+#include "./scan-timer.h"
+#include "./time.h"
+#include "./scheduler.h"
+
+// ----------------------------------------------------------------------------
+
+#if SCHEDULER_MAX_TASKS > 8
+	#error "SCHEDULER_MAX_TASKS must fit in a `uint8_t` bitmap"
+#endif
+
+// the length of a scan period, in cycles
+#define  PERIOD_CYCLES  ( (uint32_t) F_CPU / SCAN_TIMER_RATE )
+
+// ----------------------------------------------------------------------------
+
+static struct scheduler_task * _tasks;
+static uint8_t                 _count;
+static volatile uint8_t        _ready;  // bit 'i' is set if task 'i' is ready
+
+// ----------------------------------------------------------------------------
+
+/*
+ * init()
+ * - 'tasks' is a table of 'count' tasks, in order of priority (highest
+ *   first).  Accounting fields should start at 0.
+ */
+void scheduler_init(struct scheduler_task * tasks, uint8_t count) {
+	_tasks = tasks;
+	_count = (count > SCHEDULER_MAX_TASKS) ? SCHEDULER_MAX_TASKS : count;
+	_ready = 0;
+}
+
+/*
+ * ready()
+ * - Mark 'task' (an index into the table) ready to run.  Safe to call from
+ *   interrupts.
+ */
+void scheduler_ready(uint8_t task) {
+	if (task >= _count)
+		return;
+
+	uint8_t sreg = SREG;
+	cli();
+	_ready |= (1 << task);
+	SREG = sreg;
+}
+
+/*
+ * run()
+ * - Run ready tasks, highest priority first, until none are ready (or the
+ *   next one has to be put off).  Call once at the start of every scan
+ *   period.
+ */
+void scheduler_run(void) {
+	uint32_t start = time_cycles();
+
+	for (;;) {
+		uint8_t ready = _ready;
+		if (!ready)
+			return;
+
+		uint8_t                 id   = __builtin_ctz(ready);
+		struct scheduler_task * task = &_tasks[id];
+
+		uint32_t begin = time_cycles();
+
+		if ( task->budget && !task->deferred
+		     && (begin - start) + task->budget > PERIOD_CYCLES ) {
+			task->deferred = true;
+			task->deferrals++;
+			return;
+		}
+
+		uint8_t sreg = SREG;
+		cli();
+		_ready &= ~(1 << id);
+		SREG = sreg;
+
+		task->deferred = false;
+		(*task->function)();
+
+		uint32_t cycles = time_cycles() - begin;
+
+		task->runs++;
+		task->cycles_total += cycles;
+		if (cycles > task->cycles_max)
+			task->cycles_max = cycles;
+		if (task->budget && cycles > task->budget)
+			task->overruns++;
+	}
+}
+
+/*
+ * task_get()
+ *
+ * Returns
+ * - success: a pointer to 'task' (an index into the table), e.g. to read its
+ *   accounting
+ * - failure: `NULL` (out of range)
+ */
+struct scheduler_task * scheduler_task_get(uint8_t task) {
+	return (task < _count) ? &_tasks[task] : NULL;
+}
+
@@ -0,0 +1,54 @@
+/* ----------------------------------------------------------------------------
+ * Task scheduler : exports
+ *
+ * A run-to-completion scheduler for the main loop: tasks are plain functions,
+ * made ready by setting a flag, and run in order of priority.  Nothing is
+ * allocated at runtime; the task table belongs to whoever uses it (usually
+ * `main()`).
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2026 agent <agent@local>
+ * Released under The MIT License (MIT) (see "license.md")
+ * Project located at <https://github.com/benblazak/ergodox-firmware>
+ * ------------------------------------------------------------------------- */
+
+
+#ifndef LIB__SCHEDULER_h
+	#define LIB__SCHEDULER_h
+
+	#include <stdbool.h>
+	#include <stdint.h>
+	#include "./data-types/misc.h"
+
+	// --------------------------------------------------------------------
+
+	// the most tasks there can be (one ready flag each, in a `uint8_t`)
+	#define  SCHEDULER_MAX_TASKS  8
+
+	// --------------------------------------------------------------------
+
+	struct scheduler_task {
+		// set by the user
+		void_funptr_t function;
+		uint16_t      budget;        // in cycles; 0: never put off
+
+		// accounting (kept by `scheduler_run()`)
+		uint16_t      runs;
+		uint16_t      overruns;      // runs that took longer than `budget`
+		uint16_t      deferrals;     // times it was put off to a later scan
+		uint32_t      cycles_max;    // the longest run
+		uint32_t      cycles_total;  // over all runs (for the mean)
+
+		// (private)
+		bool          deferred;      // put off last time it was ready
+	};
+
+	// --------------------------------------------------------------------
+
+	void                    scheduler_init     ( struct scheduler_task * tasks,
+	                                             uint8_t count );
+	void                    scheduler_ready    (uint8_t task);
+	void                    scheduler_run      (void);
+	struct scheduler_task * scheduler_task_get (uint8_t task);
+
+#endif
+
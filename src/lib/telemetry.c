@@ -0,0 +1,244 @@
+/* ----------------------------------------------------------------------------
+ * Telemetry and control : code
+ *
+ * - Requests are handled in place: the reply is written over the request,
+ *   so only one buffer is needed.
+ * - This is run from the main loop (as a task; see "main.c"), not from an
+ *   interrupt, so it can call anything the main loop can.
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2026 agent <agent@local>
+ * Released under The MIT License (MIT) (see "license.md")
+ * Project located at <https://github.com/benblazak/ergodox-firmware>
+ * ------------------------------------------------------------------------- */
+
+
+#include <stdint.h>
+#include "../keyboard/layout.h"
+#include "../keyboard/matrix.h"
+#include "../main.h"
+#include "./eeprom-keymap.h"
+#include "./latency.h"
+#include "./profile.h"
+#include "./scan-timer.h"
+#include "./scheduler.h"
+#include "./time.h"
+#include "./telemetry.h"
+
+#if MAKEFILE_RAWHID
+
+// ----------------------------------------------------------------------------
+
+#ifndef MAKEFILE_KEYMAP_CACHE
+	#define MAKEFILE_KEYMAP_CACHE 0
+#endif
+
+// where things are in a packet
+#define  COMMAND    0
+#define  SEQUENCE   1
+#define  ARGUMENTS  2  // in requests
+#define  STATUS     2  // in replies
+#define  DATA       3  // in replies
+
+#define  DATA_SIZE  (TELEMETRY_PACKET_SIZE - DATA)
+
+#if KB_ROWS * 2 * 2 > DATA_SIZE
+	#error "the matrix doesn't fit in a telemetry packet"
+#endif
+
+// the most histogram buckets in one reply (after stage, first, and count)
+#define  BUCKETS_PER_REPLY  ( (DATA_SIZE - 3) / 2 )
+
+// ----------------------------------------------------------------------------
+
+static uint8_t * _put8(uint8_t * p, uint8_t value) {
+	*p++ = value;
+	return p;
+}
+
+static uint8_t * _put16(uint8_t * p, uint16_t value) {
+	*p++ = value;
+	*p++ = value >> 8;
+	return p;
+}
+
+static uint8_t * _put32(uint8_t * p, uint32_t value) {
+	p = _put16(p, value);
+	return _put16(p, value >> 16);
+}
+
+// ----------------------------------------------------------------------------
+
+/*
+ * handle()
+ * - Carry out the request in 'packet', and replace it with the reply.
+ */
+void telemetry_handle(uint8_t packet[TELEMETRY_PACKET_SIZE]) {
+	// copy the arguments out, since the reply goes over them
+	uint8_t arg[5];
+	for (uint8_t i=0; i<sizeof(arg); i++)
+		arg[i] = packet[ARGUMENTS+i];
+
+	uint8_t   status = TELEMETRY_OK;
+	uint8_t * p      = &packet[DATA];
+
+	for (uint8_t i=DATA; i<TELEMETRY_PACKET_SIZE; i++)
+		packet[i] = 0;
+
+	switch (packet[COMMAND]) {
+		case TELEMETRY_INFO:
+			p = _put8  (p, TELEMETRY_VERSION);
+			p = _put8  (p, KB_ROWS);
+			p = _put8  (p, KB_COLUMNS);
+			p = _put8  (p, KB_LAYERS);
+			p = _put16 (p, SCAN_TIMER_RATE);
+			p = _put8  (p, F_CPU / 1000000);
+			p = _put8  (p, (MAKEFILE_LATENCY_HISTOGRAMS ? 1<<0 : 0)
+			             | (MAKEFILE_PROFILE            ? 1<<1 : 0)
+			             | (MAKEFILE_EEPROM_KEYMAP      ? 1<<2 : 0)
+			             | (MAKEFILE_KEYMAP_CACHE       ? 1<<3 : 0) );
+			p = _put8  (p, LATENCY_STAGES);
+			p = _put8  (p, LATENCY_BUCKETS + 1);
+			p = _put8  (p, LATENCY_BUCKET_SHIFT);
+			p = _put8  (p, PROFILE_REGIONS);
+			break;
+
+		case TELEMETRY_COUNTERS:
+			p = _put32 (p, time_ms());
+			p = _put16 (p, scan_timer_rate);
+			p = _put16 (p, scan_timer_jitter_max);
+			p = _put16 (p, scan_timer_overruns);
+			#if MAKEFILE_LATENCY_HISTOGRAMS
+				p = _put16 (p, latency_dropped);
+			#endif
+			break;
+
+		case TELEMETRY_TASK: {
+			struct scheduler_task * task = scheduler_task_get(arg[0]);
+			if (!task) {
+				status = TELEMETRY_BAD_ARGUMENT;
+				break;
+			}
+			p = _put16 (p, task->budget);
+			p = _put16 (p, task->runs);
+			p = _put16 (p, task->overruns);
+			p = _put16 (p, task->deferrals);
+			p = _put32 (p, task->cycles_max);
+			p = _put32 (p, task->cycles_total);
+			break;
+		}
+
+		case TELEMETRY_HISTOGRAM:
+			#if MAKEFILE_LATENCY_HISTOGRAMS
+			{
+				uint8_t stage = arg[0];
+				uint8_t first = arg[1];
+				if (stage >= LATENCY_STAGES || first > LATENCY_BUCKETS) {
+					status = TELEMETRY_BAD_ARGUMENT;
+					break;
+				}
+				uint8_t count = LATENCY_BUCKETS + 1 - first;
+				if (count > BUCKETS_PER_REPLY)
+					count = BUCKETS_PER_REPLY;
+
+				p = _put8 (p, stage);
+				p = _put8 (p, first);
+				p = _put8 (p, count);
+				for (uint8_t b=first; b<first+count; b++)
+					p = _put16 (p, latency_histograms[stage][b]);
+			}
+			#else
+				status = TELEMETRY_DISABLED;
+			#endif
+			break;
+
+		case TELEMETRY_PROFILE:
+			#if MAKEFILE_PROFILE
+			{
+				if (arg[0] >= PROFILE_REGIONS) {
+					status = TELEMETRY_BAD_ARGUMENT;
+					break;
+				}
+				struct profile_region * r = &profile_regions[arg[0]];
+				p = _put16 (p, r->runs);
+				p = _put32 (p, r->cycles_min);
+				p = _put32 (p, r->cycles_max);
+				p = _put32 (p, r->cycles_total);
+			}
+			#else
+				status = TELEMETRY_DISABLED;
+			#endif
+			break;
+
+		case TELEMETRY_MATRIX:
+			for (uint8_t row=0; row<KB_ROWS; row++)
+				p = _put16 (p, main_kb_raw[row]);
+			for (uint8_t row=0; row<KB_ROWS; row++)
+				p = _put16 (p, (*main_kb_is_pressed)[row]);
+			break;
+
+		case TELEMETRY_KEYMAP_GET:
+			if ( arg[0] >= KB_LAYERS
+			     || arg[1] >= KB_ROWS || arg[2] >= KB_COLUMNS ) {
+				status = TELEMETRY_BAD_ARGUMENT;
+				break;
+			}
+			p = _put16 (p, kb_layout_action_get(arg[0], arg[1], arg[2]));
+			break;
+
+		case TELEMETRY_CLEAR:
+			#if MAKEFILE_LATENCY_HISTOGRAMS
+				if (arg[0] & 1<<0)
+					latency_clear();
+			#endif
+			#if MAKEFILE_PROFILE
+				if (arg[0] & 1<<1)
+					profile_clear();
+			#endif
+			break;
+
+		case TELEMETRY_KEYMAP_SET:
+			#if MAKEFILE_EEPROM_KEYMAP
+			{
+				uint16_t action = arg[3] | (uint16_t) arg[4] << 8;
+				// (a key that's down would be released with the new
+				// action, instead of the one it was pressed with; check
+				// the last scan too, in case its release hasn't been
+				// run yet)
+				if ( arg[1] < KB_ROWS && arg[2] < KB_COLUMNS
+				     && ( ( (*main_kb_is_pressed)[arg[1]]
+				            | (*main_kb_was_pressed)[arg[1]] )
+				          >> arg[2] & 1 ) ) {
+					status = TELEMETRY_BUSY;
+					break;
+				}
+				switch (eeprom_keymap_set(arg[0], arg[1], arg[2], action)) {
+					case 0:  break;
+					case 1:  status = TELEMETRY_BAD_ARGUMENT; break;
+					default: status = TELEMETRY_FULL;         break;
+				}
+			}
+			#else
+				status = TELEMETRY_DISABLED;
+			#endif
+			break;
+
+		case TELEMETRY_KEYMAP_CLEAR:
+			#if MAKEFILE_EEPROM_KEYMAP
+				eeprom_keymap_clear();
+			#else
+				status = TELEMETRY_DISABLED;
+			#endif
+			break;
+
+		default:
+			status = TELEMETRY_UNKNOWN_COMMAND;
+			break;
+	}
+
+	packet[STATUS] = status;
+}
+
+// ----------------------------------------------------------------------------
+
+#endif
+
@@ -0,0 +1,69 @@
+/* ----------------------------------------------------------------------------
+ * Telemetry and control : exports
+ *
+ * Commands the host can send over the raw HID interface (see
+ * "lib-other/pjrc/usb_keyboard/usb_keyboard.h"), to read counters,
+ * histograms, and the matrix, and to remap keys.  Enabled by modifying a
+ * variable in the makefile.
+ *
+ * Packets are `TELEMETRY_PACKET_SIZE` bytes, each way.  Multi-byte values
+ * are little-endian.
+ * - request: command, sequence number, arguments...
+ * - reply: command, sequence number (both copied from the request), status,
+ *   data...
+ *
+ * See "build-scripts/telemetry.py" for a host side tool (and the meaning of
+ * the reply data for each command).
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2026 agent <agent@local>
+ * Released under The MIT License (MIT) (see "license.md")
+ * Project located at <https://github.com/benblazak/ergodox-firmware>
+ * ------------------------------------------------------------------------- */
+
+
+#ifndef LIB__TELEMETRY_h
+	#define LIB__TELEMETRY_h
+
+	#include <stdint.h>
+
+	// --------------------------------------------------------------------
+
+	#ifndef MAKEFILE_RAWHID
+		#define MAKEFILE_RAWHID 0
+	#endif
+
+	#define  TELEMETRY_PACKET_SIZE  32
+	#define  TELEMETRY_VERSION      1  // of the protocol
+
+	// --------------------------------------------------------------------
+
+	enum telemetry_commands {
+		// reading
+		TELEMETRY_INFO          = 0x00,  // -
+		TELEMETRY_COUNTERS      = 0x01,  // -
+		TELEMETRY_TASK          = 0x02,  // task
+		TELEMETRY_HISTOGRAM     = 0x03,  // stage, first bucket
+		TELEMETRY_PROFILE       = 0x04,  // region
+		TELEMETRY_MATRIX        = 0x05,  // -
+		TELEMETRY_KEYMAP_GET    = 0x06,  // layer, row, column
+		// writing
+		TELEMETRY_CLEAR         = 0x10,  // what (1: latency, 2: profile)
+		TELEMETRY_KEYMAP_SET    = 0x11,  // layer, row, column, action
+		TELEMETRY_KEYMAP_CLEAR  = 0x12,  // -
+	};
+
+	enum telemetry_status {
+		TELEMETRY_OK,
+		TELEMETRY_UNKNOWN_COMMAND,
+		TELEMETRY_BAD_ARGUMENT,  // e.g. an action the layout doesn't have
+		TELEMETRY_DISABLED,  // not compiled in (see "makefile-options")
+		TELEMETRY_FULL,      // e.g. too many keys remapped already
+		TELEMETRY_BUSY,      // e.g. remapping a key that's pressed
+	};
+
+	// --------------------------------------------------------------------
+
+	void telemetry_handle (uint8_t packet[TELEMETRY_PACKET_SIZE]);
+
+#endif
+
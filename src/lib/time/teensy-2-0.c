@@ -0,0 +1,127 @@
+/* ----------------------------------------------------------------------------
+ * Monotonic time : Teensy 2.0 : code
+ *
+ * - Timer3 is run in CTC mode at the CPU clock, with a compare match every
+ *   millisecond.  The interrupt counts milliseconds (and the cycles in
+ *   them); the counter itself gives the time within the millisecond, to the
+ *   cycle.
+ * - Timer0 is used for the scan timer (see "../scan-timer"), and Timer1 for
+ *   the LED PWM (see "keyboard/ergodox/controller").
+ * - See the datasheet, section 14 ("16-bit Timer/Counter (Timer/Counter 1 and
+ *   3)").
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2026 agent <agent@local>
+ * Released under The MIT License (MIT) (see "license.md")
+ * Project located at <https://github.com/benblazak/ergodox-firmware>
+ * ------------------------------------------------------------------------- */
+
+
+// ----------------------------------------------------------------------------
+// conditional compile
+#if MAKEFILE_BOARD == teensy-2-0
+// ----------------------------------------------------------------------------
+
+
+#include <stdint.h>
+#include <avr/interrupt.h>
+#include <avr/io.h>
+#include "./teensy-2-0.h"
+
+// ----------------------------------------------------------------------------
+
+// timer clock: F_CPU (no prescaling)
+#define  TIMER_TOP       (F_CPU / 1000 - 1)
+#define  COUNTS_PER_US   (F_CPU / 1000000)
+
+#if TIMER_TOP > 0xFFFF
+	#error "Timer3 can't count that high; use a prescaler"
+#endif
+#if F_CPU % 1000000
+	#error "F_CPU must be a whole number of MHz"
+#endif
+
+// ----------------------------------------------------------------------------
+
+static volatile uint32_t _ms;
+static volatile uint32_t _cycles;  // at the start of the current millisecond
+
+// ----------------------------------------------------------------------------
+
+ISR(TIMER3_COMPA_vect) {
+	_ms++;
+	_cycles += TIMER_TOP + 1;
+}
+
+// ----------------------------------------------------------------------------
+
+/*
+ * Read a count and the timer together (atomically)
+ * - If the timer has just reset, but its interrupt hasn't run yet (because
+ *   interrupts are disabled), the count is corrected here by 'step'.
+ */
+static inline uint32_t _read( volatile uint32_t * count,
+                              uint32_t            step,
+                              uint16_t *          counts ) {
+	uint8_t sreg = SREG;
+	cli();
+
+	uint32_t value = *count;
+	*counts = TCNT3;
+	if ((TIFR3 & (1<<OCF3A)) && *counts < TIMER_TOP/2)
+		value += step;
+
+	SREG = sreg;
+	return value;
+}
+
+// ----------------------------------------------------------------------------
+
+void time_init(void) {
+	TCCR3A = 0;
+	TCCR3B = (1<<WGM32)|(1<<CS30);  // CTC mode (TOP = OCR3A); clock: F_CPU
+	OCR3A  = TIMER_TOP;
+	TIMSK3 = (1<<OCIE3A);           // enable compare match A interrupt
+}
+
+/*
+ * ms()
+ *
+ * Returns
+ * - the number of milliseconds since `time_init()`
+ */
+uint32_t time_ms(void) {
+	uint16_t counts;
+	return _read(&_ms, 1, &counts);
+}
+
+/*
+ * us()
+ *
+ * Returns
+ * - the number of microseconds since `time_init()`, modulo 2^16 (so it's only
+ *   good for measuring intervals of less than 65.536 ms)
+ */
+uint16_t time_us(void) {
+	uint16_t counts;
+	uint16_t ms = _read(&_ms, 1, &counts);
+
+	return ms * 1000 + counts / COUNTS_PER_US;
+}
+
+/*
+ * cycles()
+ *
+ * Returns
+ * - the number of CPU cycles since `time_init()`, modulo 2^32 (so it's only
+ *   good for measuring intervals of less than 2^32 cycles)
+ */
+uint32_t time_cycles(void) {
+	uint16_t counts;
+	return _read(&_cycles, TIMER_TOP + 1, &counts) + counts;
+}
+
+
+// ----------------------------------------------------------------------------
+#endif
+// ----------------------------------------------------------------------------
+
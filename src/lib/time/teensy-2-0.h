@@ -0,0 +1,23 @@
+/* ----------------------------------------------------------------------------
+ * Monotonic time : Teensy 2.0 : exports
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2026 agent <agent@local>
+ * Released under The MIT License (MIT) (see "license.md")
+ * Project located at <https://github.com/benblazak/ergodox-firmware>
+ * ------------------------------------------------------------------------- */
+
+
+#ifndef TIME_h
+	#define TIME_h
+
+	#include <stdint.h>
+
+	// --------------------------------------------------------------------
+
+	void     time_init   (void);
+	uint32_t time_ms     (void);  // since `time_init()`; wraps in ~49.7 days
+	uint16_t time_us     (void);  // wraps every 65.536 ms
+	uint32_t time_cycles (void);  // CPU cycles; wraps in ~268 s (at 16 MHz)
+
+#endif
+
@@ -0,0 +1,166 @@
+/* ----------------------------------------------------------------------------
+ * Software timers : code
+ *
+ * A hashed timing wheel: armed timers are kept in `TIMER_WHEEL_SLOTS` lists,
+ * by the low bits of the millisecond they're due.  `timer_wheel_run()` goes
+ * through each millisecond since it was last called, and only looks at the
+ * timers in that millisecond's slot.
+ *
+ * - Timers fire in order of when they're due, and timers due at the same time
+ *   fire in the order they were started.
+ * - Times are compared for equality only, so the millisecond count wrapping
+ *   around (after ~49.7 days) doesn't matter.
+ * - Periodic timers are rescheduled from when they were due (not from when
+ *   they ran), so they don't drift.  If the main loop falls behind, missed
+ *   periods all run (late) when it catches up.
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2026 agent <agent@local>
+ * Released under The MIT License (MIT) (see "license.md")
+ * Project located at <https://github.com/benblazak/ergodox-firmware>
+ * ------------------------------------------------------------------------- */
+
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "./data-types/misc.h"
+#include "./time.h"
+#include "./timer-wheel.h"
+
+// ----------------------------------------------------------------------------
+
+#if TIMER_WHEEL_SLOTS & (TIMER_WHEEL_SLOTS - 1)
+	#error "TIMER_WHEEL_SLOTS must be a power of 2"
+#endif
+
+#define  SLOT(ms)  ( (uint8_t)(ms) & (TIMER_WHEEL_SLOTS - 1) )
+
+// ----------------------------------------------------------------------------
+
+static struct timer * _slots[TIMER_WHEEL_SLOTS];
+static uint8_t        _armed;  // the number of timers in the wheel
+static uint32_t       _now;    // the last millisecond we ran timers for
+
+// ----------------------------------------------------------------------------
+
+/*
+ * Add 'timer' to the end of its slot
+ */
+static void _insert(struct timer * timer) {
+	struct timer ** link = &_slots[SLOT(timer->due)];
+	while (*link)
+		link = &(*link)->next;
+
+	timer->next = NULL;
+	*link = timer;
+	_armed++;
+}
+
+/*
+ * Find the link that points to 'timer'
+ *
+ * Returns
+ * - success: a pointer to the link
+ * - failure: `NULL` (the timer isn't armed)
+ */
+static struct timer ** _find(struct timer * timer) {
+	struct timer ** link = &_slots[SLOT(timer->due)];
+	while (*link && *link != timer)
+		link = &(*link)->next;
+
+	return (*link) ? link : NULL;
+}
+
+// ----------------------------------------------------------------------------
+
+/*
+ * start()
+ * - Arm 'timer' to call 'function' in 'delay' ms, and then every 'period' ms
+ *   (or only once, if 'period' is 0).  If 'timer' was already armed, it's
+ *   restarted.
+ * - A 'delay' of 0 means the next time `timer_wheel_run()` is called (after
+ *   the current millisecond).
+ */
+void timer_wheel_start( struct timer * timer,
+                        uint16_t       delay,
+                        uint16_t       period,
+                        void_funptr_t  function ) {
+	timer_wheel_stop(timer);
+
+	uint32_t now = time_ms();
+	if (!_armed)
+		_now = now;  // nothing to catch up on
+
+	timer->due      = now + delay;
+	timer->period   = period;
+	timer->function = function;
+
+	// we've already run the current millisecond (if we're caught up)
+	if (timer->due == _now)
+		timer->due++;
+
+	_insert(timer);
+}
+
+/*
+ * stop()
+ * - Disarm 'timer' (if it's armed)
+ */
+void timer_wheel_stop(struct timer * timer) {
+	struct timer ** link = _find(timer);
+	if (!link)
+		return;
+
+	*link = timer->next;
+	_armed--;
+}
+
+/*
+ * is_armed()
+ */
+bool timer_wheel_is_armed(struct timer * timer) {
+	return _find(timer);
+}
+
+/*
+ * run()
+ * - Call the functions of all the timers that have come due since the last
+ *   call (in the order they came due).  Should be called once per scan.
+ * - Functions may start and stop timers (including their own).
+ */
+void timer_wheel_run(void) {
+	uint32_t now = time_ms();
+
+	// (if a function starts the first timer, `_now` may jump ahead of 'now')
+	while (_armed && (int32_t)(now - _now) > 0) {
+		_now++;
+
+		struct timer ** link = &_slots[SLOT(_now)];
+		while (*link) {
+			struct timer * timer = *link;
+			if (timer->due != _now) {
+				link = &timer->next;
+				continue;
+			}
+
+			// take it out (so 'function' can restart it), and put it back
+			// (at the end of a later slot) if it's periodic
+			*link = timer->next;
+			_armed--;
+			if (timer->period) {
+				timer->due += timer->period;
+				_insert(timer);
+			}
+
+			(*timer->function)();
+
+			// 'function' may have changed this slot, so start it over (the
+			// timers we've already run aren't due now anymore)
+			link = &_slots[SLOT(_now)];
+		}
+	}
+
+	if ((int32_t)(now - _now) > 0)
+		_now = now;
+}
+
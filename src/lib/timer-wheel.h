@@ -0,0 +1,48 @@
+/* ----------------------------------------------------------------------------
+ * Software timers : exports
+ *
+ * One-shot and periodic callbacks, run from the main loop (not from an
+ * interrupt), with millisecond resolution.  Timers are allocated by whoever
+ * uses them (usually as a `static struct timer`), so there's no limit on how
+ * many there can be.
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2026 agent <agent@local>
+ * Released under The MIT License (MIT) (see "license.md")
+ * Project located at <https://github.com/benblazak/ergodox-firmware>
+ * ------------------------------------------------------------------------- */
+
+
+#ifndef LIB__TIMER_WHEEL_h
+	#define LIB__TIMER_WHEEL_h
+
+	#include <stdbool.h>
+	#include <stdint.h>
+	#include "./data-types/misc.h"
+
+	// --------------------------------------------------------------------
+
+	// the number of slots in the wheel (must be a power of 2)
+	#define  TIMER_WHEEL_SLOTS  8
+
+	// --------------------------------------------------------------------
+
+	// (private; use the functions below)
+	struct timer {
+		struct timer * next;      // the next timer in the same slot
+		uint32_t       due;       // in ms (see "time.h")
+		uint16_t       period;    // in ms; 0 for one-shot timers
+		void_funptr_t  function;
+	};
+
+	// --------------------------------------------------------------------
+
+	void timer_wheel_start    ( struct timer * timer,
+	                            uint16_t       delay,
+	                            uint16_t       period,
+	                            void_funptr_t  function );
+	void timer_wheel_stop     (struct timer * timer);
+	bool timer_wheel_is_armed (struct timer * timer);
+	void timer_wheel_run      (void);
+
+#endif
+
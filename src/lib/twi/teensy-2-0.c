@@ -27,6 +27,11 @@
 // ----------------------------------------------------------------------------
 
 
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <avr/interrupt.h>
+#include <util/atomic.h>
 #include <util/twi.h>
 #include "./teensy-2-0.h"
 
@@ -88,6 +93,176 @@ uint8_t twi_read(uint8_t * data) {
 	return 0;  // success
 }
 
+/*
+ * Like `twi_read()`, but send NACK
+ * - For the last byte of a read: the slave then releases the bus, so that a
+ *   repeated start (or stop) can follow
+ */
+uint8_t twi_read_last(uint8_t * data) {
+	// read 1 byte to TWDR, send NACK
+	TWCR = (1<<TWINT)|(1<<TWEN);
+	// wait for transmission to complete
+	while (!(TWCR & (1<<TWINT)));
+	// set data variable
+	*data = TWDR;
+	// if it didn't work, return the status code (else return 0)
+	if (TW_STATUS != TW_MR_DATA_NACK)
+		return TW_STATUS;  // error
+	return 0;  // success
+}
+
+
+/* ----------------------------------------------------------------------------
+ * asynchronous (interrupt driven) transactions
+ *
+ * - The ISR runs once for each bus event (start sent, byte sent or received,
+ *   etc.), so the CPU is free while each byte is on the bus.
+ * - See the datasheet, section 20.6 ("Using the TWI"), and section 20.7.1
+ *   (figure 20-12) and 20.7.2 (figure 20-14) for the order of events.
+ * ------------------------------------------------------------------------- */
+
+#define  TWCR_BASE  ( (1<<TWINT)|(1<<TWEN)|(1<<TWIE) )
+
+static struct twi_transaction * _queue[TWI_QUEUE_SIZE];
+static uint8_t _queue_head;    // index of the transaction in progress
+static volatile uint8_t _queue_length;
+
+static uint8_t _index;    // of the next byte to send or receive
+static bool    _reading;  // whether we're in the read half
+
+/*
+ * Finish the current transaction, and start the next (if there is one)
+ *
+ * Arguments
+ * - 'status': 0 (success), or the twi status code of the error
+ */
+static void _finish(uint8_t status) {
+	struct twi_transaction * t = _queue[_queue_head];
+	bool repeated_start = (!status && t->no_stop);
+
+	t->status = status;
+	if (t->callback)
+		(*t->callback)(t);
+
+	_queue_head = (_queue_head + 1) % TWI_QUEUE_SIZE;
+	_queue_length--;
+
+	_index = 0;
+	_reading = false;
+
+	if (!_queue_length)
+		TWCR = (1<<TWINT)|(1<<TWEN)|(1<<TWSTO);  // stop, and go idle
+	else if (repeated_start)
+		TWCR = TWCR_BASE|(1<<TWSTA);
+	else
+		TWCR = TWCR_BASE|(1<<TWSTO)|(1<<TWSTA);  // stop, then start
+}
+
+ISR(TWI_vect) {
+	struct twi_transaction * t = _queue[_queue_head];
+
+	switch (TW_STATUS) {
+		case TW_START:
+		case TW_REP_START:
+			// read-only transactions skip the write half
+			if (!t->write_length && t->read_length)
+				_reading = true;
+			TWDR = (t->address<<1) | ( (_reading) ? TW_READ : TW_WRITE );
+			TWCR = TWCR_BASE;
+			return;
+
+		case TW_MT_SLA_ACK:
+		case TW_MT_DATA_ACK:
+			if (_index < t->write_length) {
+				TWDR = t->write_data[_index++];
+				TWCR = TWCR_BASE;
+			} else if (t->read_length) {
+				_index = 0;
+				_reading = true;
+				TWCR = TWCR_BASE|(1<<TWSTA);  // repeated start
+			} else {
+				_finish(0);
+			}
+			return;
+
+		case TW_MR_DATA_ACK:
+			t->read_data[_index++] = TWDR;
+			// fall through
+		case TW_MR_SLA_ACK:
+			// ACK every byte but the last
+			if (_index+1 < t->read_length)
+				TWCR = TWCR_BASE|(1<<TWEA);
+			else
+				TWCR = TWCR_BASE;
+			return;
+
+		case TW_MR_DATA_NACK:
+			t->read_data[_index++] = TWDR;
+			_finish(0);
+			return;
+
+		default:  // error (no ACK, arbitration lost, bus error, ...)
+			_finish(TW_STATUS);
+			return;
+	}
+}
+
+// ----------------------------------------------------------------------------
+
+/*
+ * queue()
+ *
+ * Arguments
+ * - 'transaction': the transaction to queue (see "teensy-2-0.h")
+ *
+ * Returns
+ * - success: 0
+ * - failure: 1 (the queue is full)
+ */
+uint8_t twi_queue(struct twi_transaction * transaction) {
+	uint8_t ret = 1;
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		if (_queue_length < TWI_QUEUE_SIZE) {
+			transaction->status = TWI_PENDING;
+			_queue[ (_queue_head + _queue_length) % TWI_QUEUE_SIZE ]
+				= transaction;
+			// if the bus was idle, send start
+			if (!_queue_length++) {
+				// wait for the last (idle) stop to finish
+				while (TWCR & (1<<TWSTO));
+				TWCR = TWCR_BASE|(1<<TWSTA);
+			}
+			ret = 0;
+		}
+	}
+
+	return ret;
+}
+
+/*
+ * busy()
+ *
+ * Returns
+ * - whether there are any queued transactions that haven't finished
+ */
+bool twi_busy(void) {
+	return _queue_length;
+}
+
+/*
+ * wait()
+ * - Wait for a queued transaction to finish
+ *
+ * Returns
+ * - success: 0
+ * - failure: the twi status code of the error
+ */
+uint8_t twi_wait(struct twi_transaction * transaction) {
+	while (transaction->status == TWI_PENDING);
+	return transaction->status;
+}
+
 
 // ----------------------------------------------------------------------------
 #endif
@@ -12,10 +12,52 @@
 
 	// --------------------------------------------------------------------
 
+	#include <stdbool.h>
+	#include <stdint.h>
+
+	// --------------------------------------------------------------------
+
 	#ifndef TWI_FREQ
 		#define TWI_FREQ 100000  // in Hz
 	#endif
 
+	#ifndef TWI_QUEUE_SIZE
+		#define TWI_QUEUE_SIZE 4  // max transactions waiting at once
+	#endif
+
+	// `status` of a transaction that hasn't finished yet
+	// - twi status codes are all multiples of 8, so this can't be one
+	#define TWI_PENDING 0xFF
+
+	// --------------------------------------------------------------------
+
+	/*
+	 * A transaction, for the interrupt driven (asynchronous) functions
+	 *
+	 * - The transaction is: start, SLA+W, `write_data`, [repeated] start,
+	 *   SLA+R, `read_data`, stop.  Either half may be left out by setting
+	 *   its length to 0.
+	 * - If `no_stop` is set, and there's another transaction queued when
+	 *   this one finishes, it's started with a repeated start instead of a
+	 *   stop and a start.
+	 * - `callback` (if not NULL) is called from the ISR when the
+	 *   transaction finishes (successfully or not).  It should be short.
+	 * - `status` is set to `TWI_PENDING` when the transaction is queued,
+	 *   then to 0 (success) or the twi status code of the error.
+	 * - The transaction, and its buffers, must stay valid until it's
+	 *   finished.
+	 */
+	struct twi_transaction {
+		uint8_t   address;  // 7 bits, not shifted
+		uint8_t * write_data;
+		uint8_t   write_length;
+		uint8_t * read_data;
+		uint8_t   read_length;
+		bool      no_stop;
+		void   (* callback)(struct twi_transaction * transaction);
+		volatile uint8_t status;
+	};
+
 	// --------------------------------------------------------------------
 
 	void    twi_init  (void);
@@ -23,6 +65,13 @@
 	void    twi_stop  (void);
 	uint8_t twi_send  (uint8_t data);
 	uint8_t twi_read  (uint8_t * data);
+	uint8_t twi_read_last (uint8_t * data);
+
+	// asynchronous
+	// - don't use the functions above while `twi_busy()`
+	uint8_t twi_queue (struct twi_transaction * transaction);
+	bool    twi_busy  (void);
+	uint8_t twi_wait  (struct twi_transaction * transaction);
 
 #endif
 
@@ -12,7 +12,17 @@
 #include <stdint.h>
 #include <util/delay.h>
 #include "./lib-other/pjrc/usb_keyboard/usb_keyboard.h"
+#include "./lib/data-types/misc.h"
+#include "./lib/debounce.h"
+#include "./lib/eeprom-keymap.h"
 #include "./lib/key-functions/public.h"
+#include "./lib/latency.h"
+#include "./lib/profile.h"
+#include "./lib/scan-timer.h"
+#include "./lib/scheduler.h"
+#include "./lib/telemetry.h"
+#include "./lib/time.h"
+#include "./lib/timer-wheel.h"
 #include "./keyboard/controller.h"
 #include "./keyboard/layout.h"
 #include "./keyboard/matrix.h"
@@ -20,15 +30,24 @@
 
 // ----------------------------------------------------------------------------
 
-#define  MAX_ACTIVE_LAYERS  20
+#ifndef MAX_ACTIVE_LAYERS
+	#define MAX_ACTIVE_LAYERS 20
+#endif
+
+#ifndef MAKEFILE_KEYMAP_CACHE
+	#define MAKEFILE_KEYMAP_CACHE 0
+#endif
 
 // ----------------------------------------------------------------------------
 
-static bool _main_kb_is_pressed[KB_ROWS][KB_COLUMNS];
-bool (*main_kb_is_pressed)[KB_ROWS][KB_COLUMNS] = &_main_kb_is_pressed;
+// one `uint16_t` per row (see "keyboard/matrix.h")
+uint16_t main_kb_raw[KB_ROWS];  // as read, before debouncing
+
+static uint16_t _main_kb_is_pressed[KB_ROWS];
+uint16_t (*main_kb_is_pressed)[KB_ROWS] = &_main_kb_is_pressed;
 
-static bool _main_kb_was_pressed[KB_ROWS][KB_COLUMNS];
-bool (*main_kb_was_pressed)[KB_ROWS][KB_COLUMNS] = &_main_kb_was_pressed;
+static uint16_t _main_kb_was_pressed[KB_ROWS];
+uint16_t (*main_kb_was_pressed)[KB_ROWS] = &_main_kb_was_pressed;
 
 uint8_t main_layers_pressed[KB_ROWS][KB_COLUMNS];
 
@@ -39,17 +58,55 @@ uint8_t main_arg_layer;
 uint8_t main_arg_layer_offset;
 uint8_t main_arg_row;
 uint8_t main_arg_col;
+uint8_t main_arg_keycode;
 bool    main_arg_is_pressed;
 bool    main_arg_was_pressed;
 
 // ----------------------------------------------------------------------------
 
+// tasks, in order of priority (see "lib/scheduler.h")
+enum main_tasks {
+	TASK_SCAN,       // read the matrix, and debounce
+	TASK_DISPATCH,   // "execute" keys that changed, and run software timers
+	TASK_REPORT,     // send the USB report
+	TASK_TELEMETRY,  // answer the host, on the raw HID interface
+	TASK_LEDS,       // update the LEDs
+	TASK_EEPROM,     // save remapped keys (a little at a time)
+	TASKS_COUNT
+};
+
+static void _task_scan      (void);
+static void _task_dispatch  (void);
+static void _task_report    (void);
+static void _task_telemetry (void);
+static void _task_leds      (void);
+static void _task_eeprom    (void);
+
+// budgets are in cycles (see "lib/scheduler.c"); 0 means the task is never
+// put off, so scanning and reporting always come before cosmetic work
+static struct scheduler_task _tasks[TASKS_COUNT] = {
+	[TASK_SCAN]      = { .function = &_task_scan,      .budget = 0    },
+	[TASK_DISPATCH]  = { .function = &_task_dispatch,  .budget = 0    },
+	[TASK_REPORT]    = { .function = &_task_report,    .budget = 0    },
+	[TASK_TELEMETRY] = { .function = &_task_telemetry, .budget = 3000 },
+	[TASK_LEDS]      = { .function = &_task_leds,      .budget = 500  },
+	[TASK_EEPROM]    = { .function = &_task_eeprom,    .budget = 6000 },
+};
+
+// ----------------------------------------------------------------------------
+
 /*
  * main()
  */
 int main(void) {
 	kb_init();  // does controller initialization too
 
+	time_init();
+
+	#if MAKEFILE_EEPROM_KEYMAP
+		eeprom_keymap_init();
+	#endif
+
 	kb_led_state_power_on();
 
 	usb_init();
@@ -58,74 +115,191 @@ int main(void) {
 
 	kb_led_state_ready();
 
+	scheduler_init(_tasks, TASKS_COUNT);
+	scan_timer_init();
+
 	for (;;) {
-		// swap `main_kb_is_pressed` and `main_kb_was_pressed`, then update
-		bool (*temp)[KB_ROWS][KB_COLUMNS] = main_kb_was_pressed;
-		main_kb_was_pressed = main_kb_is_pressed;
-		main_kb_is_pressed = temp;
-
-		kb_update_matrix(*main_kb_is_pressed);
-
-		// this loop is responsible to
-		// - "execute" keys when they change state
-		// - keep track of which layers the keys were on when they were pressed
-		//   (so they can be released using the function from that layer)
-		//
-		// note
-		// - everything else is the key function's responsibility
-		//   - see the keyboard layout file ("keyboard/ergodox/layout/*.c") for
-		//     which key is assigned which function (per layer)
-		//   - see "lib/key-functions/public/*.c" for the function definitions
-		#define row          main_loop_row
-		#define col          main_loop_col
-		#define layer        main_arg_layer
-		#define is_pressed   main_arg_is_pressed
-		#define was_pressed  main_arg_was_pressed
-		for (row=0; row<KB_ROWS; row++) {
-			for (col=0; col<KB_COLUMNS; col++) {
-				is_pressed = (*main_kb_is_pressed)[row][col];
-				was_pressed = (*main_kb_was_pressed)[row][col];
-
-				if (is_pressed != was_pressed) {
-					if (is_pressed) {
-						layer = main_layers_peek(0);
-						main_layers_pressed[row][col] = layer;
-					} else {
-						layer = main_layers_pressed[row][col];
-					}
-
-					// set remaining vars, and "execute" key
-					main_arg_row          = row;
-					main_arg_col          = col;
-					main_arg_layer_offset = 0;
-					main_exec_key();
-				}
+		// wait for the start of the next scan period
+		scan_timer_wait();
+
+		// the scan makes dispatch ready, and dispatch makes the report ready
+		scheduler_ready(TASK_SCAN);
+		scheduler_ready(TASK_LEDS);
+		#if MAKEFILE_RAWHID
+			scheduler_ready(TASK_TELEMETRY);
+		#endif
+		#if MAKEFILE_EEPROM_KEYMAP
+			scheduler_ready(TASK_EEPROM);
+		#endif
+
+		scheduler_run();
+	}
+
+	return 0;
+}
+
+// ----------------------------------------------------------------------------
+
+/*
+ * Scan task
+ * - Swap `main_kb_is_pressed` and `main_kb_was_pressed`, then update.
+ */
+static void _task_scan(void) {
+	uint16_t (*temp)[KB_ROWS] = main_kb_was_pressed;
+	main_kb_was_pressed = main_kb_is_pressed;
+	main_kb_is_pressed = temp;
+
+	kb_update_matrix(main_kb_raw);
+
+	PROFILE_BEGIN(CHANGES);
+	debounce_update( main_kb_raw,
+	                 *main_kb_was_pressed,
+	                 *main_kb_is_pressed );
+	PROFILE_END(CHANGES);
+
+	scheduler_ready(TASK_DISPATCH);
+}
+
+/*
+ * Dispatch task
+ *
+ * This loop is responsible to
+ * - "execute" keys when they change state
+ * - keep track of which layers the keys were on when they were pressed (so
+ *   they can be released using the function from that layer)
+ *
+ * Note
+ * - everything else is the key function's responsibility
+ *   - see the keyboard layout files (in "keyboard/ergodox/layout") for which
+ *     key is assigned which function (per layer)
+ *   - see the files in "lib/key-functions/public" for the function
+ *     definitions
+ */
+static void _task_dispatch(void) {
+	PROFILE_BEGIN(DISPATCH);
+
+	#define row          main_loop_row
+	#define col          main_loop_col
+	#define layer        main_arg_layer
+	#define is_pressed   main_arg_is_pressed
+	#define was_pressed  main_arg_was_pressed
+	// - XOR each row with its previous state, and only look at the columns
+	//   that changed (usually none)
+	for (row=0; row<KB_ROWS; row++) {
+		uint16_t changed = (*main_kb_is_pressed)[row]
+		                 ^ (*main_kb_was_pressed)[row];
+
+		for (col=0; changed; col++, changed >>= 1) {
+			if (!(changed & 1))
+				continue;
+
+			is_pressed = ( (*main_kb_is_pressed)[row] >> col ) & 1;
+			was_pressed = !is_pressed;
+
+			// set remaining vars, and "execute" key
+			main_arg_row          = row;
+			main_arg_col          = col;
+			main_arg_layer_offset = 0;
+
+			if (is_pressed) {
+				#if MAKEFILE_KEYMAP_CACHE
+					// transparency is already resolved
+					main_keymap_cache_exec_press();
+					continue;
+				#else
+					layer = main_layers_peek(0);
+					main_layers_pressed[row][col] = layer;
+				#endif
+			} else {
+				layer = main_layers_pressed[row][col];
 			}
+
+			main_exec_key();
 		}
-		#undef row
-		#undef col
-		#undef layer
-		#undef is_pressed
-		#undef was_pressed
-
-		// send the USB report (even if nothing's changed)
-		usb_keyboard_send();
-		_delay_ms(MAKEFILE_DEBOUNCE_TIME);
-
-		// update LEDs
-		if (keyboard_leds & (1<<0)) { kb_led_num_on(); }
-		else { kb_led_num_off(); }
-		if (keyboard_leds & (1<<1)) { kb_led_caps_on(); }
-		else { kb_led_caps_off(); }
-		if (keyboard_leds & (1<<2)) { kb_led_scroll_on(); }
-		else { kb_led_scroll_off(); }
-		if (keyboard_leds & (1<<3)) { kb_led_compose_on(); }
-		else { kb_led_compose_off(); }
-		if (keyboard_leds & (1<<4)) { kb_led_kana_on(); }
-		else { kb_led_kana_off(); }
 	}
+	#undef row
+	#undef col
+	#undef layer
+	#undef is_pressed
+	#undef was_pressed
 
-	return 0;
+	// run the software timers that have come due (before sending the report,
+	// so keys they press or release go out this scan)
+	timer_wheel_run();
+
+	PROFILE_END(DISPATCH);
+
+	scheduler_ready(TASK_REPORT);
+}
+
+/*
+ * Report task
+ * - Send the USB report (only if something's changed).  The USB SOF interrupt
+ *   resends it when the host's idle rate says to, so we don't have to wait on
+ *   the endpoint every scan.
+ * - No delay here: debouncing is done per key, in the scan task.
+ */
+static void _task_report(void) {
+	PROFILE_BEGIN(USB_SEND);
+	usb_keyboard_send_if_changed();
+	PROFILE_END(USB_SEND);
+}
+
+/*
+ * Telemetry task
+ * - Answer at most one request per call.  A reply that can't be sent yet (if
+ *   the host hasn't read the last one) is kept, and no more requests are
+ *   read until it's gone.
+ */
+static void _task_telemetry(void) {
+	#if MAKEFILE_RAWHID
+		#if RAWHID_SIZE != TELEMETRY_PACKET_SIZE
+			#error "RAWHID_SIZE and TELEMETRY_PACKET_SIZE must match"
+		#endif
+
+		static uint8_t packet[TELEMETRY_PACKET_SIZE];
+		static bool    pending;  // a reply is waiting to be sent
+
+		if (!pending) {
+			if (usb_rawhid_recv(packet) <= 0)
+				return;
+			telemetry_handle(packet);
+			pending = true;
+		}
+
+		if (!usb_rawhid_send(packet))
+			pending = false;
+	#endif
+}
+
+/*
+ * LED task
+ */
+static void _task_leds(void) {
+	PROFILE_BEGIN(LEDS);
+
+	if (keyboard_leds & (1<<0)) { kb_led_num_on(); }
+	else { kb_led_num_off(); }
+	if (keyboard_leds & (1<<1)) { kb_led_caps_on(); }
+	else { kb_led_caps_off(); }
+	if (keyboard_leds & (1<<2)) { kb_led_scroll_on(); }
+	else { kb_led_scroll_off(); }
+	if (keyboard_leds & (1<<3)) { kb_led_compose_on(); }
+	else { kb_led_compose_off(); }
+	if (keyboard_leds & (1<<4)) { kb_led_kana_on(); }
+	else { kb_led_kana_off(); }
+
+	PROFILE_END(LEDS);
+}
+
+/*
+ * EEPROM task
+ * - Writes at most one byte per call, and never waits on the EEPROM.
+ */
+static void _task_eeprom(void) {
+	#if MAKEFILE_EEPROM_KEYMAP
+		eeprom_keymap_writeback();
+	#endif
 }
 
 // ----------------------------------------------------------------------------
@@ -143,12 +317,22 @@ int main(void) {
  * Exec key
  * - Execute the keypress or keyrelease function (if it exists) of the key at
  *   the current possition.
+ * - The key's action word is read once, and its keycode passed to the key
+ *   function in `main_arg_keycode`.
  */
 void main_exec_key(void) {
+	uint16_t action = kb_layout_action_get(layer, row, col);
+
+	main_arg_keycode = kb_action_keycode(action);
+
+	#if MAKEFILE_LATENCY_HISTOGRAMS
+		latency_dispatched();
+	#endif
+
 	void (*key_function)(void) =
 		( (is_pressed)
-		  ? kb_layout_press_get(layer, row, col)
-		  : kb_layout_release_get(layer, row, col) );
+		  ? kb_action_press_get(action)
+		  : kb_action_release_get(action) );
 
 	if (key_function)
 		(*key_function)();
@@ -162,21 +346,36 @@ void main_exec_key(void) {
  * may appear in the stack more than once.  The base layer will always be
  * layer-0.  
  *
- * Implemented as a fixed size stack.
+ * Implemented as a doubly linked list of elements, indexed by element id:
+ * - Element 0 is the base layer, and is always at the bottom.
+ * - Free ids are kept in a bitmap, so finding one doesn't mean searching.
+ * - `push()`, `pop_id()`, and `peek(0)` take the same time no matter how
+ *   many elements are in the stack.  `peek(offset)` and `get_offset_id()`
+ *   walk down from the top.
  * ------------------------------------------------------------------------- */
 
+#if MAX_ACTIVE_LAYERS < 1 || MAX_ACTIVE_LAYERS > 32
+	#error "MAX_ACTIVE_LAYERS must fit in a `uint32_t` bitmap"
+#endif
+
 // ----------------------------------------------------------------------------
 
-struct layers {
-	uint8_t layer;
-	uint8_t id;
-};
+static uint8_t layers_layer[MAX_ACTIVE_LAYERS];  // layer-number, by id
+static uint8_t layers_below[MAX_ACTIVE_LAYERS];  // id of the next element down
+static uint8_t layers_above[MAX_ACTIVE_LAYERS];  // id of the next element up
+static uint8_t layers_top = 0;                   // id of the head element
 
-// ----------------------------------------------------------------------------
+// bit 'id' is set if 'id' is free (id 0, the base layer, never is)
+// - (shifted down rather than built up, so that 32 ids don't shift by 32)
+static uint32_t layers_ids_free =
+	( UINT32_MAX >> (32 - MAX_ACTIVE_LAYERS) ) & ~1UL;
 
-struct layers layers[MAX_ACTIVE_LAYERS];
-uint8_t       layers_head = 0;
-uint8_t       layers_ids_in_use[MAX_ACTIVE_LAYERS] = {true};
+#if MAKEFILE_KEYMAP_CACHE
+	// see "Keymap Cache" (below)
+	static bool _cache_stale;
+	static void _cache_cover(uint8_t layer);
+	static void _cache_uncover(uint8_t layer);
+#endif
 
 /*
  * peek()
@@ -189,10 +388,15 @@ uint8_t       layers_ids_in_use[MAX_ACTIVE_LAYERS] = {true};
  * - failure: 0 (default) (out of bounds)
  */
 uint8_t main_layers_peek(uint8_t offset) {
-	if (offset <= layers_head)
-		return layers[layers_head - offset].layer;
+	uint8_t id = layers_top;
 
-	return 0;  // default, or error
+	for (; offset; offset--) {
+		if (id == 0)
+			return 0;  // default, or error
+		id = layers_below[id];
+	}
+
+	return layers_layer[id];
 }
 
 /*
@@ -206,18 +410,28 @@ uint8_t main_layers_peek(uint8_t offset) {
  * - failure: 0 (the stack was already full)
  */
 uint8_t main_layers_push(uint8_t layer) {
-	// look for an available id
-	for (uint8_t id=1; id<MAX_ACTIVE_LAYERS; id++)
-		// if one is found
-		if (layers_ids_in_use[id] == false) {
-			layers_ids_in_use[id] = true;
-			layers_head++;
-			layers[layers_head].layer = layer;
-			layers[layers_head].id = id;
-			return id;
-		}
+	if (!layers_ids_free)
+		return 0;  // default, or error
 
-	return 0;  // default, or error
+	// take the lowest free id
+	uint8_t id = __builtin_ctzl(layers_ids_free);
+	layers_ids_free &= ~(1UL << id);
+
+	layers_layer[id] = layer;
+	layers_below[id] = layers_top;
+	layers_above[layers_top] = id;
+	layers_top = id;
+
+	#if MAKEFILE_EEPROM_KEYMAP
+		eeprom_keymap_layer_activate(layer);
+	#endif
+
+	#if MAKEFILE_KEYMAP_CACHE
+		if (!_cache_stale)
+			_cache_cover(layer);
+	#endif
+
+	return id;
 }
 
 /*
@@ -227,22 +441,36 @@ uint8_t main_layers_push(uint8_t layer) {
  * - 'id': the id of the element to pop from the stack
  */
 void main_layers_pop_id(uint8_t id) {
-	// look for the element with the id we want to pop
-	for (uint8_t element=1; element<=layers_head; element++)
-		// if we find it
-		if (layers[element].id == id) {
-			// move all layers above it down one
-			for (; element<layers_head; element++) {
-				layers[element].layer = layers[element+1].layer;
-				layers[element].id = layers[element+1].id;
-			}
-			// reinitialize the topmost (now unused) slot
-			layers[layers_head].layer = 0;
-			layers[layers_head].id = 0;
-			// record keeping
-			layers_ids_in_use[id] = false;
-			layers_head--;
-		}
+	// ignore the base layer, and ids that aren't in use
+	if ( id == 0 || id >= MAX_ACTIVE_LAYERS
+	     || (layers_ids_free & (1UL << id)) )
+		return;
+
+	// unlink the element
+	uint8_t below = layers_below[id];
+	if (id == layers_top) {
+		layers_top = below;
+	} else {
+		uint8_t above = layers_above[id];
+		layers_below[above] = below;
+		layers_above[below] = above;
+	}
+
+	// record keeping
+	#if MAKEFILE_KEYMAP_CACHE
+		uint8_t popped = layers_layer[id];
+	#endif
+	layers_layer[id] = 0;
+	layers_ids_free |= (1UL << id);
+
+	#if MAKEFILE_EEPROM_KEYMAP
+		eeprom_keymap_layer_activate(layers_layer[layers_top]);
+	#endif
+
+	#if MAKEFILE_KEYMAP_CACHE
+		if (!_cache_stale)
+			_cache_uncover(popped);
+	#endif
 }
 
 /*
@@ -258,15 +486,156 @@ void main_layers_pop_id(uint8_t id) {
  */
 uint8_t main_layers_get_offset_id(uint8_t id) {
 	// look for the element with the id we want to get the offset of
-	for (uint8_t element=1; element<=layers_head; element++)
+	uint8_t offset = 0;
+	for (uint8_t element=layers_top; element; element=layers_below[element]) {
 		// if we find it
-		if (layers[element].id == id)
-			return (layers_head - element);
+		if (element == id)
+			return offset;
+		offset++;
+	}
 
 	return 0;  // default, or error
 
 }
 
+
+/* ----------------------------------------------------------------------------
+ * Keymap Cache
+ * ----------------------------------------------------------------------------
+ * If enabled (see "makefile-options"), we keep the effective keymap in RAM:
+ * for every key, the layer its press would end up on after following
+ * transparent keys down the layer stack, and the action word from that layer.
+ * That way a keypress doesn't have to search the layer stack, or read from
+ * PROGMEM at all.
+ *
+ * Releases are still looked up when the key is released, using the layer
+ * recorded in `main_layers_pressed` (as before); that lookup isn't a search.
+ *
+ * Keeping things current:
+ * - `push()` updates the cache in place: the new layer covers every key
+ *   that isn't transparent on it, and leaves the rest as they were.
+ * - `pop_id()` updates the cache in place too: only the keys that had
+ *   resolved to the popped layer are looked up again (by searching down the
+ *   stack from the top).
+ * - Remapping a key (see "lib/eeprom-keymap.h") marks the cache stale, and
+ *   it's rebuilt (by searching the stack for every key) before the next
+ *   keypress is looked up.  So does starting up.
+ * ------------------------------------------------------------------------- */
+
+#if MAKEFILE_KEYMAP_CACHE
+
+static uint8_t       _cache_layer[KB_ROWS][KB_COLUMNS];
+static uint16_t      _cache_action[KB_ROWS][KB_COLUMNS];
+static bool          _cache_stale = true;
+
+/*
+ * Cover the cache with 'layer' (which is now on top of the stack), except
+ * where it's transparent
+ */
+static void _cache_cover(uint8_t layer) {
+	for (uint8_t r=0; r<KB_ROWS; r++) {
+		for (uint8_t c=0; c<KB_COLUMNS; c++) {
+			uint16_t action = kb_layout_action_get(layer, r, c);
+			if (kb_action_press_get(action) == &kbfun_transparent)
+				continue;
+
+			_cache_layer[r][c]  = layer;
+			_cache_action[r][c] = action;
+		}
+	}
+}
+
+/*
+ * Look up the keys that had resolved to 'layer' (which has just been popped)
+ * again
+ * - If 'layer' is still in the stack (pushed more than once), some of these
+ *   will resolve to it again.  Keys that resolved to any other layer can't
+ *   have changed.
+ * - Keys that are transparent on every layer in the stack resolve to layer 0
+ *   with no action (action word 0).
+ */
+static void _cache_uncover(uint8_t layer) {
+	for (uint8_t r=0; r<KB_ROWS; r++) {
+		for (uint8_t c=0; c<KB_COLUMNS; c++) {
+			if (_cache_layer[r][c] != layer)
+				continue;
+
+			_cache_layer[r][c]  = 0;
+			_cache_action[r][c] = 0;
+
+			for (uint8_t id=layers_top;; id=layers_below[id]) {
+				uint8_t  l = layers_layer[id];
+				uint16_t action = kb_layout_action_get(l, r, c);
+				if (kb_action_press_get(action) != &kbfun_transparent) {
+					_cache_layer[r][c]  = l;
+					_cache_action[r][c] = action;
+					break;
+				}
+				if (id == 0)
+					break;
+			}
+		}
+	}
+}
+
+/*
+ * Rebuild the whole cache from the layer stack
+ * - Keys that are transparent on every layer in the stack resolve to layer 0
+ *   with no action (action word 0).
+ */
+static void _cache_rebuild(void) {
+	for (uint8_t r=0; r<KB_ROWS; r++) {
+		for (uint8_t c=0; c<KB_COLUMNS; c++) {
+			_cache_layer[r][c]  = 0;
+			_cache_action[r][c] = 0;
+		}
+	}
+
+	// walk up from the bottom, so each layer covers the ones below it
+	for (uint8_t id=0;; id=layers_above[id]) {
+		_cache_cover(layers_layer[id]);
+		if (id == layers_top)
+			break;
+	}
+
+	_cache_stale = false;
+}
+
+/*
+ * Invalidate the cache (e.g. after a key is remapped)
+ * - It's rebuilt before the next keypress is looked up.
+ */
+void main_keymap_cache_invalidate(void) {
+	_cache_stale = true;
+}
+
+/*
+ * Exec press (of the key at the current position, using the cache)
+ * - Sets `main_arg_layer` and `main_layers_pressed[row][col]` to the layer
+ *   the key resolved to, and calls the press function (if there is one).
+ */
+void main_keymap_cache_exec_press(void) {
+	if (_cache_stale)
+		_cache_rebuild();
+
+	uint16_t action = _cache_action[row][col];
+
+	layer = _cache_layer[row][col];
+	main_layers_pressed[row][col] = layer;
+	main_arg_keycode = kb_action_keycode(action);
+
+	#if MAKEFILE_LATENCY_HISTOGRAMS
+		latency_dispatched();
+	#endif
+
+	void_funptr_t key_function = kb_action_press_get(action);
+	if (key_function)
+		(*key_function)();
+}
+
+#endif
+
+
 /* ----------------------------------------------------------------------------
  * ------------------------------------------------------------------------- */
 
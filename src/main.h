@@ -16,8 +16,10 @@
 
 	// --------------------------------------------------------------------
 
-	extern bool (*main_kb_is_pressed)[KB_ROWS][KB_COLUMNS];
-	extern bool (*main_kb_was_pressed)[KB_ROWS][KB_COLUMNS];
+	// one `uint16_t` per row (see "keyboard/matrix.h")
+	extern uint16_t   main_kb_raw[KB_ROWS];  // before debouncing
+	extern uint16_t (*main_kb_is_pressed)[KB_ROWS];
+	extern uint16_t (*main_kb_was_pressed)[KB_ROWS];
 
 	extern uint8_t main_layers_pressed[KB_ROWS][KB_COLUMNS];
 
@@ -28,12 +30,15 @@
 	extern uint8_t main_arg_layer_offset;
 	extern uint8_t main_arg_row;
 	extern uint8_t main_arg_col;
+	extern uint8_t main_arg_keycode;
 	extern bool    main_arg_is_pressed;
 	extern bool    main_arg_was_pressed;
 
 	// --------------------------------------------------------------------
 
 	void main_exec_key (void);
+	void main_keymap_cache_exec_press (void);  // if MAKEFILE_KEYMAP_CACHE
+	void main_keymap_cache_invalidate (void);  // if MAKEFILE_KEYMAP_CACHE
 
 	uint8_t main_layers_peek          (uint8_t offset);
 	uint8_t main_layers_push          (uint8_t layer);
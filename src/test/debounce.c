@@ -0,0 +1,157 @@
+/* ----------------------------------------------------------------------------
+ * Host tests : debounce
+ *
+ * Feed simulated switch traces through `debounce_update()`, for every key in
+ * the matrix at once, and check that the selected algorithm reports each
+ * change once, at the scan it should.  The traces have
+ * - clean stretches, of at least 5 debounce times
+ * - presses and releases that bounce for up to `DEBOUNCE_SCANS - 1` scans
+ *   after the edge (the switch is assumed to settle within the debounce
+ *   time)
+ * - single scan noise spikes, in the middle of some of the released
+ *   stretches
+ *
+ * Built once for each algorithm (see "makefile").
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2026 agent <agent@local>
+ * Released under The MIT License (MIT) (see "license.md")
+ * Project located at <https://github.com/benblazak/ergodox-firmware>
+ * ------------------------------------------------------------------------- */
+
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "../keyboard/matrix.h"
+#include "../lib/debounce.h"
+#include "../lib/variable-include.h"
+#include "./test.h"
+
+// ----------------------------------------------------------------------------
+
+#define  N       DEBOUNCE_SCANS
+#define  KEYS    (KB_ROWS * KB_COLUMNS)
+#define  SCANS   (1000 * N)
+
+static bool _raw[KEYS][SCANS];       // what the switch reads
+static bool _expected[KEYS][SCANS];  // what should be reported
+
+static const char * _algorithm = EXP_STR(MAKEFILE_DEBOUNCE_ALGORITHM);
+
+static unsigned _edges, _spikes;
+
+// ----------------------------------------------------------------------------
+
+/*
+ * Note that the key should read 'pressed' from scan 'scan' on
+ */
+static void _expect(uint8_t key, uint32_t scan, bool pressed) {
+	for (; scan < SCANS; scan++)
+		_expected[key][scan] = pressed;
+}
+
+/*
+ * Write a trace for 'key', and what each algorithm should make of it
+ */
+static void _generate(uint8_t key) {
+	uint32_t scan = 0;
+	bool pressed = false;
+
+	for (;;) {
+		// a stable stretch
+		uint32_t length = 5*N + test_random() % (2*N);
+		if (scan + length + 2*N >= SCANS)
+			break;
+		for (uint32_t i = 0; i < length; i++)
+			_raw[key][scan+i] = pressed;
+
+		// (maybe) a noise spike in it, after the last change has been
+		// reported, and long enough before the next edge that it's been
+		// dealt with
+		if (!pressed && test_random() % 3 == 0) {
+			uint32_t spike = scan + 2*N;
+			_raw[key][spike] = true;
+			_spikes++;
+
+			if (!strcmp(_algorithm, "eager")) {
+				_expect(key, spike, true);
+				_expect(key, spike + N+1, false);
+			} else if (!strcmp(_algorithm, "asymmetric")) {
+				_expect(key, spike, true);
+				_expect(key, spike + N, false);
+			}
+		}
+		scan += length;
+
+		// an edge, and some bounce
+		// - 'last' is the last scan that reads the old value (the scan
+		//   before the edge, if there's no bounce)
+		uint32_t bounce = test_random() % N;
+		uint32_t last = scan - 1;
+
+		pressed = !pressed;
+		_raw[key][scan] = pressed;
+		for (uint32_t i = 1; i <= bounce; i++) {
+			_raw[key][scan+i] = (test_random() & 1) ? pressed : !pressed;
+			if (_raw[key][scan+i] != pressed)
+				last = scan+i;
+		}
+		_edges++;
+
+		if (!strcmp(_algorithm, "eager"))
+			_expect(key, scan, pressed);
+		else if (!strcmp(_algorithm, "asymmetric") && pressed)
+			_expect(key, scan, pressed);
+		else
+			_expect(key, last + N, pressed);
+
+		scan += bounce + 1;
+	}
+
+	for (; scan < SCANS; scan++)
+		_raw[key][scan] = pressed;
+}
+
+// ----------------------------------------------------------------------------
+
+int main(void) {
+	for (uint8_t key = 0; key < KEYS; key++)
+		_generate(key);
+
+	uint16_t raw[KB_ROWS];
+	uint16_t was_pressed[KB_ROWS] = {0};
+	uint16_t is_pressed[KB_ROWS];
+	unsigned wrong = 0;
+
+	for (uint32_t scan = 0; scan < SCANS; scan++) {
+		for (uint8_t row = 0; row < KB_ROWS; row++) {
+			raw[row] = 0;
+			for (uint8_t col = 0; col < KB_COLUMNS; col++)
+				KB_MATRIX_SET( raw, row, col,
+				               _raw[row*KB_COLUMNS + col][scan] );
+		}
+
+		debounce_update(raw, was_pressed, is_pressed);
+
+		for (uint8_t row = 0; row < KB_ROWS; row++) {
+			for (uint8_t col = 0; col < KB_COLUMNS; col++) {
+				bool got  = is_pressed[row] & (1U << col);
+				bool want = _expected[row*KB_COLUMNS + col][scan];
+				if (got != want && wrong++ < 10)
+					TEST_CHECK( false, "scan %u, key (%u, %u): got %d, "
+					            "expected %d", (unsigned) scan, row, col,
+					            got, want );
+			}
+		}
+
+		memcpy(was_pressed, is_pressed, sizeof(was_pressed));
+	}
+
+	TEST_CHECK(!wrong, "%u wrong key states in all", wrong);
+
+	printf( "debounce (%s, %u scans): %u keys, %u edges, %u spikes\n",
+	        _algorithm, (unsigned) N, KEYS, _edges, _spikes );
+	TEST_EXIT("debounce");
+}
+
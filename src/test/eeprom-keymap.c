@@ -0,0 +1,263 @@
+/* ----------------------------------------------------------------------------
+ * Host tests : EEPROM keymap
+ *
+ * Remap keys at random with "../lib/eeprom-keymap.c", going around the log
+ * many times, and cut the power at a random point in every run: after some
+ * number of bytes have been written to the EEPROM, the run stops before
+ * writing the next one.  Then start up again (from the EEPROM, as it was left)
+ * and check that
+ * - every key whose remap was saved, and hasn't been changed since, still has
+ *   it
+ * - every key that was being changed has one of the values it was given
+ *   since its last saved one
+ *
+ * Each run is a child process, so that everything in RAM starts over.  The
+ * EEPROM (the "eeprom" section, see "stub/avr/eeprom.h") is kept here, in the
+ * parent: the child sends each byte it writes (and each remap it makes, and
+ * when they've all been saved) through a pipe.
+ *
+ * Remaps only ever go to `KEYS` different keys, fewer than
+ * `EEPROM_KEYMAP_REMAPS`, so none are refused.
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2026 agent <agent@local>
+ * Released under The MIT License (MIT) (see "license.md")
+ * Project located at <https://github.com/benblazak/ergodox-firmware>
+ * ------------------------------------------------------------------------- */
+
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "../lib/data-types/misc.h"
+#include "../lib/eeprom-keymap.h"
+#include "../keyboard/matrix.h"
+#include "./test.h"
+
+// ----------------------------------------------------------------------------
+
+#define  RUNS      2000  // each cut short at random
+#define  LAYERS    4     // `KB_LAYERS`, in "layout.h"
+#define  ACTIONS   4     // `KB_ACTIONS`, in the same
+#define  KEYS      24    // that are remapped (less than `EEPROM_KEYMAP_REMAPS`)
+#define  BATCH     4     // the most remaps made before waiting for them to save
+
+// ----------------------------------------------------------------------------
+// the layout, and what `eeprom-keymap.c` needs from the rest of the firmware
+// ----------------------------------------------------------------------------
+
+uint16_t _kb_layout_actions[LAYERS][KB_ROWS][KB_COLUMNS];
+
+const void_funptr_t _kb_actions[ACTIONS][2];
+
+static struct { uint8_t layer, row, column; } _keys[KEYS];
+
+static uint16_t _random_action(void) {
+	return (test_random() % ACTIONS) << 8 | (test_random() & 0xFF);
+}
+
+// ----------------------------------------------------------------------------
+// the EEPROM
+// ----------------------------------------------------------------------------
+
+extern uint8_t __start_eeprom[], __stop_eeprom[];
+
+static int      _pipe;        // to the parent (in a child)
+static uint32_t _writes_left; // before the power's cut (in a child)
+
+// what's sent through the pipe
+// - WRITE: a byte written to the EEPROM
+// - STARTED: what a key was after starting up (which must be what's saved)
+// - REMAP: a key given a new value
+// - SAVED: every remap so far has been written
+enum { WRITE, STARTED, REMAP, SAVED };
+struct message {
+	uint8_t  type;
+	uint8_t  key;     // an index in `_keys`
+	uint16_t offset;  // in the EEPROM
+	uint16_t value;   // the byte, or the action
+};
+
+static void _send(struct message m) {
+	if (write(_pipe, &m, sizeof(m)) != sizeof(m))
+		_exit(2);
+}
+
+uint8_t eeprom_read_byte(const uint8_t * address) {
+	return *address;
+}
+
+void eeprom_read_block(void * dst, const void * src, unsigned n) {
+	memcpy(dst, src, n);
+}
+
+void eeprom_update_byte(uint8_t * address, uint8_t value) {
+	if (*address == value)
+		return;
+	if (!_writes_left--)
+		_exit(0);  // the power's cut
+
+	*address = value;
+	_send((struct message) { .type = WRITE,
+	                         .offset = address - __start_eeprom,
+	                         .value = value });
+}
+
+uint8_t eeprom_is_ready(void) {
+	return 1;
+}
+
+// ----------------------------------------------------------------------------
+// what each key should be (kept in the parent)
+// ----------------------------------------------------------------------------
+
+static uint16_t _saved[KEYS];            // the last value saved
+static uint16_t _since[KEYS][BATCH];     // values given since then
+static uint8_t  _since_count[KEYS];
+
+static void _receive(int pipe) {
+	struct message m;
+	while (read(pipe, &m, sizeof(m)) == sizeof(m)) {
+		switch (m.type) {
+			case WRITE:
+				__start_eeprom[m.offset] = m.value;
+				break;
+			case STARTED:
+				_saved[m.key] = m.value;
+				_since_count[m.key] = 0;
+				break;
+			case REMAP:
+				_since[m.key][_since_count[m.key]++] = m.value;
+				break;
+			case SAVED:
+				for (uint8_t k = 0; k < KEYS; k++) {
+					if (_since_count[k])
+						_saved[k] = _since[k][_since_count[k]-1];
+					_since_count[k] = 0;
+				}
+				break;
+		}
+	}
+}
+
+// ----------------------------------------------------------------------------
+// a run (in a child)
+// ----------------------------------------------------------------------------
+
+static void _check(uint32_t run) {
+	for (uint8_t k = 0; k < KEYS; k++) {
+		uint16_t action = eeprom_keymap_action_get( _keys[k].layer,
+		                                            _keys[k].row,
+		                                            _keys[k].column );
+		bool ok = (action == _saved[k]);
+		for (uint8_t i = 0; i < _since_count[k]; i++)
+			ok = ok || (action == _since[k][i]);
+
+		TEST_CHECK( ok, "run %lu: key %u (layer %u, %u,%u): 0x%04X, "
+		            "saved as 0x%04X", (unsigned long) run, k,
+		            _keys[k].layer, _keys[k].row, _keys[k].column, action,
+		            _saved[k] );
+		_send((struct message) { .type = STARTED, .key = k,
+		                         .value = action });
+	}
+}
+
+/*
+ * Write everything that hasn't been saved yet
+ */
+static void _save(void) {
+	for (;;) {
+		uint32_t writes_left = _writes_left;
+		// (a record with nothing to change is still 5 calls)
+		for (uint8_t i = 0; i < 5; i++)
+			eeprom_keymap_writeback();
+		if (writes_left == _writes_left)
+			break;
+	}
+	_send((struct message) { .type = SAVED });
+}
+
+static void _run(uint32_t run, bool last) {
+	eeprom_keymap_init();
+	_check(run);
+	if (last || test_failures) {
+		fflush(stdout);
+		_exit(test_failures ? 1 : 0);
+	}
+
+	_writes_left = test_random() % 400;
+
+	for (;;) {
+		for (uint8_t i = 1 + test_random() % BATCH; i; i--) {
+			uint8_t  k = test_random() % KEYS;
+			// (sometimes back to what it is in flash)
+			uint16_t action =
+				(test_random() % 4)
+				? _random_action()
+				: _kb_layout_actions[ _keys[k].layer ]
+				                    [ _keys[k].row ]
+				                    [ _keys[k].column ];
+			if (eeprom_keymap_set( _keys[k].layer, _keys[k].row,
+			                       _keys[k].column, action ))
+				_exit(3);
+			_send((struct message) { .type = REMAP, .key = k,
+			                         .value = action });
+		}
+		_save();
+	}
+}
+
+// ----------------------------------------------------------------------------
+
+int main(void) {
+	for (uint8_t l = 0; l < LAYERS; l++)
+		for (uint8_t r = 0; r < KB_ROWS; r++)
+			for (uint8_t c = 0; c < KB_COLUMNS; c++)
+				_kb_layout_actions[l][r][c] = _random_action();
+
+	for (uint8_t k = 0; k < KEYS; k++) {
+		_keys[k].layer  = k % LAYERS;
+		_keys[k].row    = k % KB_ROWS;
+		_keys[k].column = k % KB_COLUMNS;
+		_saved[k] = _kb_layout_actions[k % LAYERS][k % KB_ROWS]
+		                              [k % KB_COLUMNS];
+	}
+
+	unsigned long writes = 0;
+	for (uint32_t run = 0; run <= RUNS; run++) {
+		int fds[2];
+		if (pipe(fds))
+			return 2;
+
+		test_random();  // (so each child starts from a different state)
+		pid_t child = fork();
+		if (child == 0) {
+			close(fds[0]);
+			_pipe = fds[1];
+			_run(run, run == RUNS);
+		}
+		close(fds[1]);
+
+		// count the writes (as they're applied)
+		uint8_t before[__stop_eeprom - __start_eeprom];
+		memcpy(before, __start_eeprom, sizeof(before));
+		_receive(fds[0]);
+		close(fds[0]);
+		for (unsigned i = 0; i < sizeof(before); i++)
+			writes += before[i] != __start_eeprom[i];
+
+		int status;
+		waitpid(child, &status, 0);
+		TEST_CHECK( WIFEXITED(status) && WEXITSTATUS(status) == 0,
+		            "run %lu failed", (unsigned long) run );
+		if (test_failures)
+			break;
+	}
+
+	printf( "eeprom keymap: %u runs, each cut short, with %lu bytes "
+	        "changed\n", RUNS, writes );
+	TEST_EXIT("eeprom keymap");
+}
+
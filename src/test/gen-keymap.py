@@ -0,0 +1,152 @@
+#! /usr/bin/env python3
+# -----------------------------------------------------------------------------
+# Copyright (c) 2026 agent <agent@local>
+# Released under The MIT License (MIT) (see "license.md")
+# Project located at <https://github.com/benblazak/ergodox-firmware>
+# -----------------------------------------------------------------------------
+
+"""
+Host tests : keymap compiler
+
+Check "../../build-scripts/gen-keymap.py":
+- `resolve_transparency()`, on a small made up layout, with and without
+  'remappable'
+- that the included layouts, compiled again, are the same as the checked in
+  ones
+- that layouts whose transparent keys were resolved say so (so that they
+  can't be compiled with `EEPROM_KEYMAP`), and that `--remappable` ones don't
+- that `--flash-budget` fails, without writing anything, when it's exceeded
+
+Run from this directory (as `make` does).
+"""
+
+# -----------------------------------------------------------------------------
+
+import filecmp
+import importlib.util
+import os
+import subprocess
+import sys
+import tempfile
+
+# -----------------------------------------------------------------------------
+
+SCRIPT = '../../build-scripts/gen-keymap.py'
+SOURCE = '..'
+MATRIX = '../keyboard/ergodox/matrix.h'
+LAYOUTS = '../keyboard/ergodox/layout'
+
+spec = importlib.util.spec_from_file_location('gen_keymap', SCRIPT)
+gen_keymap = importlib.util.module_from_spec(spec)
+spec.loader.exec_module(gen_keymap)
+Key = gen_keymap.Key
+
+failures = 0
+
+def check(passed, message):
+	global failures
+	if not passed:
+		print('FAILED: ' + message)
+		failures += 1
+
+def run(*args):
+	"""Run the keymap compiler; return its exit status"""
+	return subprocess.call(
+			[ sys.executable, SCRIPT, '--source-code-path', SOURCE,
+			  '--matrix-file-path', MATRIX ] + list(args),
+			stderr=subprocess.DEVNULL )
+
+# -----------------------------------------------------------------------------
+
+def test_resolve_transparency():
+	# layer 1 is pushed from layer 0; layer 2 is never pushed
+	a, b, c = Key('prrel', '_A'), Key('prrel', '_B'), Key('prrel', '_C')
+	push = Key('push1', '1')
+	trans = Key('trans')
+	layers = [ [ push,  a,     trans, b     ],
+	           [ trans, trans, trans, c     ],
+	           [ trans, c,     trans, trans ] ]
+
+	resolved = gen_keymap.resolve_transparency(layers, {})
+	check( resolved == [ [ push,  a,           Key('none'), b ],
+	                     [ push,  a,           Key('none'), c ],
+	                     [ push,  c,           Key('none'), trans ] ],
+	       "resolve_transparency(): {}".format(
+	           [[k.c() for k in l] for l in resolved] ) )
+	check( layers[1][1] == trans,
+	       "resolve_transparency() changed its argument" )
+
+	remappable = gen_keymap.resolve_transparency(layers, {}, True)
+	check( remappable == [ [ push,  a,     Key('none'), b     ],
+	                       [ trans, trans, trans,       c     ],
+	                       [ trans, c,     trans,       trans ] ],
+	       "resolve_transparency(remappable=True): {}".format(
+	           [[k.c() for k in l] for l in remappable] ) )
+
+def test_included_layouts(directory):
+	names = sorted( name[:-len('.json')] for name in os.listdir(LAYOUTS)
+	                if name.endswith('.json') )
+	check(names, "no included layouts")
+	for name in names:
+		c_file = os.path.join(directory, name + '.c')
+		h_file = os.path.join(directory, name + '.h')
+		status = run( '--keymap-file', os.path.join(LAYOUTS, name + '.json'),
+		              '--c-file', c_file, '--h-file', h_file )
+		check(status == 0, "{}: exit status {}".format(name, status))
+		for generated in (c_file, h_file):
+			check( status == 0 and filecmp.cmp(
+			           generated,
+			           os.path.join(LAYOUTS, os.path.basename(generated)),
+			           shallow=False ),
+			       "{}: different from the checked in file".format(
+			           os.path.basename(generated) ) )
+
+def test_resolved_define(directory):
+	keymap_file = os.path.join(LAYOUTS, 'qwerty-kinesis-mod.json')
+	h_file = os.path.join(directory, 'resolved.h')
+	for extra, expected in ( ([], True), (['--remappable'], False) ):
+		status = run( '--keymap-file', keymap_file, '--encoding', 'full',
+		              '--h-file', h_file, *extra )
+		defined = status == 0 and \
+				'#define KB_TRANSPARENCY_RESOLVED' in open(h_file).read()
+		check( status == 0 and defined == expected,
+		       "--encoding full {}: KB_TRANSPARENCY_RESOLVED {}".format(
+		           ' '.join(extra), 'missing' if expected else 'defined' ) )
+
+	# sparse layouts keep their transparent keys
+	status = run( '--keymap-file', keymap_file, '--encoding', 'sparse',
+	              '--h-file', h_file )
+	check( status == 0
+	       and 'KB_TRANSPARENCY_RESOLVED' not in open(h_file).read(),
+	       "--encoding sparse: KB_TRANSPARENCY_RESOLVED defined" )
+
+def test_flash_budget(directory):
+	keymap_file = os.path.join(LAYOUTS, 'qwerty-kinesis-mod.json')
+	c_file = os.path.join(directory, 'budget.c')
+	h_file = os.path.join(directory, 'budget.h')
+	status = run( '--keymap-file', keymap_file, '--flash-budget', '10',
+	              '--c-file', c_file, '--h-file', h_file )
+	check(status == 1, "over budget: exit status {}".format(status))
+	check( not os.path.exists(c_file) and not os.path.exists(h_file),
+	       "over budget: files were written" )
+
+	status = run('--keymap-file', keymap_file, '--flash-budget', '1024')
+	check(status == 0, "under budget: exit status {}".format(status))
+
+# -----------------------------------------------------------------------------
+
+def main():
+	test_resolve_transparency()
+	with tempfile.TemporaryDirectory() as directory:
+		test_included_layouts(directory)
+		test_resolved_define(directory)
+		test_flash_budget(directory)
+
+	print('gen-keymap: {}'.format('FAILED' if failures else 'ok'))
+	sys.exit(1 if failures else 0)
+
+# -----------------------------------------------------------------------------
+
+if __name__ == '__main__':
+	main()
+
@@ -0,0 +1,203 @@
+/* ----------------------------------------------------------------------------
+ * Host tests : keymap cache
+ *
+ * Check the keymap cache in "../main.c" (compiled with `MAKEFILE_KEYMAP_CACHE`
+ * set) against a search of the layer stack, with a long random sequence of
+ * pushes and pops, on a random layout (with many transparent keys, and layers
+ * pushed more than once).  Keys are looked up through
+ * `main_keymap_cache_exec_press()`, which records the layer each one resolved
+ * to, and calls its press function (a stand-in, here, that records the
+ * keycode).
+ *
+ * After every push and pop, the layout is scrambled before the keys are looked
+ * up, and restored after.  The cache should already be current, so none of
+ * the lookups should see the scrambled layout.
+ *
+ * The layout (full matrices, in RAM, so that it can be changed) and its
+ * actions are defined here, instead of linking one of the real ones; see
+ * "layout.h".
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2026 agent <agent@local>
+ * Released under The MIT License (MIT) (see "license.md")
+ * Project located at <https://github.com/benblazak/ergodox-firmware>
+ * ------------------------------------------------------------------------- */
+
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "../lib/data-types/misc.h"
+#include "../keyboard/matrix.h"
+#include "../main.h"
+#include "./test.h"
+
+// ----------------------------------------------------------------------------
+
+#define  OPERATIONS  20000UL  // in the random sequence
+#define  LAYERS      4        // `KB_LAYERS`, in "layout.h"
+#define  ACTIONS     4        // `KB_ACTIONS`, in the same
+#define  DEPTH       8        // the most elements pushed at once
+
+// ----------------------------------------------------------------------------
+// the layout
+// ----------------------------------------------------------------------------
+
+uint16_t _kb_layout_actions[LAYERS][KB_ROWS][KB_COLUMNS];
+
+// ----------------------------------------------------------------------------
+
+static uint8_t _pressed_keycode;
+static bool    _pressed;
+
+static void _press(void) {
+	_pressed = true;
+	_pressed_keycode = main_arg_keycode;
+}
+
+void kbfun_transparent(void) {
+	TEST_CHECK(false, "a transparent key was pressed");
+}
+
+const void_funptr_t _kb_actions[ACTIONS][2] = {
+	{ NULL,               NULL },
+	{ &kbfun_transparent, &kbfun_transparent },
+	{ &_press,            NULL },
+	{ &_press,            NULL },
+};
+
+// ----------------------------------------------------------------------------
+
+static uint16_t _random_action(uint8_t transparent_in_4) {
+	uint8_t index = (test_random() % 4 < transparent_in_4)
+	                ? 1 : 2 + test_random() % (ACTIONS-2);
+	return (index << 8) | (test_random() & 0xFF);
+}
+
+/*
+ * Fill in the layout at random
+ * - The base layer is mostly not transparent, and the others mostly are.
+ */
+static void _random_layout(void) {
+	for (uint8_t r=0; r<KB_ROWS; r++)
+		for (uint8_t c=0; c<KB_COLUMNS; c++) {
+			_kb_layout_actions[0][r][c] = (test_random() % 8)
+			                              ? _random_action(0)
+			                              : (test_random() & 1) << 8;
+			for (uint8_t l=1; l<LAYERS; l++)
+				_kb_layout_actions[l][r][c] = _random_action(3);
+		}
+}
+
+// ----------------------------------------------------------------------------
+// the layer stack, as a list (bottom first)
+// ----------------------------------------------------------------------------
+
+static uint8_t _stack_layer[DEPTH+1] = {0};
+static uint8_t _stack_id[DEPTH+1]    = {0};
+static uint8_t _stack_size = 1;
+
+static void _push(void) {
+	uint8_t layer = test_random() % LAYERS;
+	uint8_t id = main_layers_push(layer);
+	TEST_CHECK(id, "push failed");
+	_stack_layer[_stack_size] = layer;
+	_stack_id[_stack_size] = id;
+	_stack_size++;
+}
+
+static void _pop(void) {
+	uint8_t i = 1 + test_random() % (_stack_size-1);
+	main_layers_pop_id(_stack_id[i]);
+	for (; i<_stack_size-1; i++) {
+		_stack_layer[i] = _stack_layer[i+1];
+		_stack_id[i] = _stack_id[i+1];
+	}
+	_stack_size--;
+}
+
+// ----------------------------------------------------------------------------
+
+/*
+ * Check every key against a search of the stack, with the layout scrambled
+ * (if 'scramble' is true) while the cache is being read
+ */
+static void _check(const char * when, bool scramble) {
+	static uint8_t  expected_layer[KB_ROWS][KB_COLUMNS];
+	static uint16_t expected_action[KB_ROWS][KB_COLUMNS];
+
+	for (uint8_t r=0; r<KB_ROWS; r++)
+		for (uint8_t c=0; c<KB_COLUMNS; c++) {
+			expected_layer[r][c]  = 0;
+			expected_action[r][c] = 0;
+			for (uint8_t i=_stack_size; i--;) {
+				uint16_t action = _kb_layout_actions[_stack_layer[i]][r][c];
+				if (action >> 8 != 1) {
+					expected_layer[r][c]  = _stack_layer[i];
+					expected_action[r][c] = action;
+					break;
+				}
+			}
+		}
+
+	static uint16_t saved[LAYERS][KB_ROWS][KB_COLUMNS];
+	if (scramble) {
+		memcpy(saved, _kb_layout_actions, sizeof(saved));
+		memset(_kb_layout_actions, 0, sizeof(_kb_layout_actions));
+	}
+
+	for (uint8_t r=0; r<KB_ROWS; r++)
+		for (uint8_t c=0; c<KB_COLUMNS; c++) {
+			main_arg_row = r;
+			main_arg_col = c;
+			_pressed = false;
+			main_keymap_cache_exec_press();
+
+			uint16_t action = expected_action[r][c];
+			bool press = (action >> 8) >= 2;
+			TEST_CHECK( main_layers_pressed[r][c] == expected_layer[r][c]
+			            && _pressed == press
+			            && (!press || _pressed_keycode == (uint8_t) action),
+			            "%s: key %u,%u: layer %u, expected %u", when, r, c,
+			            main_layers_pressed[r][c], expected_layer[r][c] );
+		}
+
+	if (scramble)
+		memcpy(_kb_layout_actions, saved, sizeof(saved));
+}
+
+static void _test_random(void) {
+	_random_layout();
+	_check("start", false);  // (the cache is built here)
+
+	for (uint32_t i=0; i<OPERATIONS; i++) {
+		if (_stack_size > 1 && ( _stack_size == DEPTH+1
+		                         || test_random() % 2 )) {
+			_pop();
+			_check("after pop", true);
+		} else {
+			_push();
+			_check("after push", true);
+		}
+
+		// now and then, change the layout, and rebuild the whole cache
+		if (i % 1000 == 999) {
+			_random_layout();
+			main_keymap_cache_invalidate();
+			_check("after invalidate", false);
+		}
+
+		if (test_failures > 10)
+			return;
+	}
+}
+
+// ----------------------------------------------------------------------------
+
+int main(void) {
+	_test_random();
+
+	printf("keymap cache: %lu random operations\n", OPERATIONS);
+	TEST_EXIT("keymap cache");
+}
+
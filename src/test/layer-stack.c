@@ -0,0 +1,234 @@
+/* ----------------------------------------------------------------------------
+ * Host tests : layer stack
+ *
+ * Check the layer stack functions in "../main.c" against the fixed size array
+ * stack they replaced (kept here, as a reference, and for comparison), with
+ * some fixed cases and a long random sequence of operations.  Then time both
+ * implementations with the stack at a few different depths.
+ *
+ * "../main.c" is compiled separately, with `main()` renamed, and linked with
+ * `--gc-sections`, so only the layer functions (and what they use) are kept.
+ * `MAX_ACTIVE_LAYERS` is set by "makefile", for both.
+ *
+ * The times are from the host, not the ATmega32U4, so only the comparison
+ * (and how each one changes with depth) means anything.
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2026 agent <agent@local>
+ * Released under The MIT License (MIT) (see "license.md")
+ * Project located at <https://github.com/benblazak/ergodox-firmware>
+ * ------------------------------------------------------------------------- */
+
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+#include "../main.h"
+#include "./test.h"
+
+// ----------------------------------------------------------------------------
+
+#define  OPERATIONS  200000UL  // in the random sequence
+#define  REPEATS     20000UL   // of each timed workload
+
+// ----------------------------------------------------------------------------
+// the old stack (a fixed size array, searched for ids)
+// ----------------------------------------------------------------------------
+
+struct layers {
+	uint8_t layer;
+	uint8_t id;
+};
+
+static struct layers layers[MAX_ACTIVE_LAYERS];
+static uint8_t       layers_head = 0;
+static uint8_t       layers_ids_in_use[MAX_ACTIVE_LAYERS] = {true};
+
+static uint8_t array_peek(uint8_t offset) {
+	if (offset <= layers_head)
+		return layers[layers_head - offset].layer;
+
+	return 0;
+}
+
+static uint8_t array_push(uint8_t layer) {
+	for (uint8_t id=1; id<MAX_ACTIVE_LAYERS; id++)
+		if (layers_ids_in_use[id] == false) {
+			layers_ids_in_use[id] = true;
+			layers_head++;
+			layers[layers_head].layer = layer;
+			layers[layers_head].id = id;
+			return id;
+		}
+
+	return 0;
+}
+
+static void array_pop_id(uint8_t id) {
+	for (uint8_t element=1; element<=layers_head; element++)
+		if (layers[element].id == id) {
+			for (; element<layers_head; element++) {
+				layers[element].layer = layers[element+1].layer;
+				layers[element].id = layers[element+1].id;
+			}
+			layers[layers_head].layer = 0;
+			layers[layers_head].id = 0;
+			layers_ids_in_use[id] = false;
+			layers_head--;
+		}
+}
+
+static uint8_t array_get_offset_id(uint8_t id) {
+	for (uint8_t element=1; element<=layers_head; element++)
+		if (layers[element].id == id)
+			return (layers_head - element);
+
+	return 0;
+}
+
+// ----------------------------------------------------------------------------
+
+/*
+ * Check that both stacks hold the same elements, in the same order
+ */
+static void _compare(const char * when) {
+	for (uint8_t offset = 0; offset <= MAX_ACTIVE_LAYERS; offset++)
+		TEST_CHECK( main_layers_peek(offset) == array_peek(offset),
+		            "%s: peek(%u): %u, expected %u", when, offset,
+		            main_layers_peek(offset), array_peek(offset) );
+
+	for (uint8_t id = 0; id <= MAX_ACTIVE_LAYERS; id++)
+		TEST_CHECK( main_layers_get_offset_id(id)
+		            == array_get_offset_id(id),
+		            "%s: get_offset_id(%u): %u, expected %u", when, id,
+		            main_layers_get_offset_id(id),
+		            array_get_offset_id(id) );
+}
+
+static void _push(uint8_t layer, const char * when) {
+	uint8_t got = main_layers_push(layer);
+	uint8_t want = array_push(layer);
+	TEST_CHECK( got == want, "%s: push(%u): id %u, expected %u",
+	            when, layer, got, want );
+}
+
+static void _pop_id(uint8_t id) {
+	main_layers_pop_id(id);
+	array_pop_id(id);
+}
+
+// ----------------------------------------------------------------------------
+
+static void _test_fixed(void) {
+	_compare("empty");
+
+	// fill the stack, and one more
+	for (uint8_t i = 1; i <= MAX_ACTIVE_LAYERS; i++)
+		_push(i % 10, "filling");
+	TEST_CHECK( main_layers_push(1) == 0, "push to a full stack" );
+	array_push(1);
+	_compare("full");
+
+	// the base layer, and ids out of range or not in use, are ignored
+	_pop_id(0);
+	_pop_id(MAX_ACTIVE_LAYERS);
+	_pop_id(0xFF);
+	_compare("after bad pops");
+
+	// pop from the middle, the top, and the bottom, then reuse the ids
+	_pop_id(MAX_ACTIVE_LAYERS / 2);
+	_pop_id(MAX_ACTIVE_LAYERS - 1);
+	_pop_id(1);
+	_pop_id(1);
+	_compare("after pops");
+	for (uint8_t i = 0; i < 3; i++)
+		_push(7, "refilling");
+	_compare("refilled");
+
+	// empty it
+	for (uint8_t id = 1; id < MAX_ACTIVE_LAYERS; id++)
+		_pop_id(id);
+	_compare("emptied");
+}
+
+static void _test_random(void) {
+	for (uint32_t i = 0; i < OPERATIONS; i++) {
+		switch (test_random() % 3) {
+			case 0:  _push(test_random() % 10, "random"); break;
+			default: _pop_id(test_random() % (MAX_ACTIVE_LAYERS + 2)); break;
+		}
+
+		if (i % 16 == 0)
+			_compare("random");
+	}
+	for (uint8_t id = 1; id < MAX_ACTIVE_LAYERS; id++)
+		_pop_id(id);
+}
+
+// ----------------------------------------------------------------------------
+
+static double _now(void) {
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+/*
+ * Time a push, `peek(0)`, and pop of the bottom element above the base layer
+ * (the worst case for the array: everything above it moves down), with
+ * 'depth' elements already in the stack
+ */
+#define BENCHMARK(push, peek, pop_id, depth, result) \
+	do { \
+		uint8_t ids[MAX_ACTIVE_LAYERS]; \
+		for (uint8_t i = 0; i < (depth); i++) \
+			ids[i] = push(1); \
+		uint8_t oldest = 0;  /* 'ids' is a ring, oldest first */ \
+		volatile uint8_t sink = 0; \
+		double start = _now(); \
+		for (uint32_t r = 0; r < REPEATS; r++) { \
+			uint8_t id = push(2); \
+			sink += peek(0); \
+			pop_id(ids[oldest]); \
+			ids[oldest] = id; \
+			if (++oldest == (depth)) \
+				oldest = 0; \
+		} \
+		(result) = (_now() - start) / REPEATS; \
+		for (uint8_t i = 0; i < (depth); i++) \
+			pop_id(ids[i]); \
+		(void) sink; \
+	} while (0)
+
+static void _benchmark(void) {
+	printf("layer stack: ns per push + peek + pop, by depth\n");
+	printf("    depth    array   linked\n");
+
+	// (leaving room for the element pushed each time)
+	uint8_t depths[] = { 1, MAX_ACTIVE_LAYERS/4, MAX_ACTIVE_LAYERS/2,
+	                     MAX_ACTIVE_LAYERS-2 };
+
+	for (uint8_t d = 0; d < sizeof(depths); d++) {
+		uint8_t depth = depths[d];
+		double array, linked;
+		BENCHMARK(array_push, array_peek, array_pop_id, depth, array);
+		BENCHMARK( main_layers_push, main_layers_peek, main_layers_pop_id,
+		           depth, linked );
+		printf("    %5u %8.1f %8.1f\n", depth, array, linked);
+	}
+
+	_compare("after the benchmark");
+}
+
+// ----------------------------------------------------------------------------
+
+int main(void) {
+	_test_fixed();
+	_test_random();
+	_benchmark();
+
+	printf( "layer stack (%u elements): %lu random operations\n",
+	        MAX_ACTIVE_LAYERS, OPERATIONS );
+	TEST_EXIT("layer stack");
+}
+
@@ -0,0 +1,32 @@
+/* ----------------------------------------------------------------------------
+ * Host tests : layout
+ *
+ * A layout header, for the tests that compile parts of the firmware that look
+ * up keys (see "makefile").  The test defines the layout, and its actions.
+ * Layers are full matrices, in RAM, so that the test can change them without
+ * knowing how they're indexed.
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2026 agent <agent@local>
+ * Released under The MIT License (MIT) (see "license.md")
+ * Project located at <https://github.com/benblazak/ergodox-firmware>
+ * ------------------------------------------------------------------------- */
+
+
+#ifndef TEST__LAYOUT_h
+	#define TEST__LAYOUT_h
+
+	#include "../keyboard/ergodox/controller.h"
+
+	// --------------------------------------------------------------------
+
+	#define KB_LAYERS 4
+
+	// 0: none, 1: transparent, others: press
+	#define KB_ACTIONS        4
+	#define KB_LAYER_ACTIONS  0ULL
+
+	#include "../keyboard/ergodox/layout/default--led-control.h"
+	#include "../keyboard/ergodox/layout/default--matrix-control.h"
+
+#endif
+
@@ -0,0 +1,259 @@
+/* ----------------------------------------------------------------------------
+ * Host tests : MCP23018 pipelined scan
+ *
+ * Run the pipelined scan in "../keyboard/ergodox/controller/mcp23018.c" (the
+ * same calls, in the same order, as `kb_update_matrix()`) against a model of
+ * the TWI library and the expander, with random keys down, and check that
+ * every scan reads them all.  This is done with the TWI queue empty, and with
+ * it filled (by transactions that aren't ours) before every column, so that
+ * `twi_queue()` fails and the blocking fallback is used.
+ *
+ * The model keeps a count of CPU cycles, from which the time per scan is
+ * reported:
+ * - 400 kHz bus, 16 MHz CPU: 9 bits (a byte and its ACK) is 360 cycles, and a
+ *   start or stop is taken to be 40
+ * - `TEENSY_COLUMN` cycles of other work (reading a Teensy column) are done
+ *   while each of our columns is on the bus
+ * - ISR overhead isn't counted, so these are lower bounds
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2026 agent <agent@local>
+ * Released under The MIT License (MIT) (see "license.md")
+ * Project located at <https://github.com/benblazak/ergodox-firmware>
+ * ------------------------------------------------------------------------- */
+
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <util/twi.h>
+#include "../lib/twi.h"
+#include "../keyboard/ergodox/matrix.h"
+#include "../keyboard/ergodox/controller/mcp23018--functions.h"
+#include "./test.h"
+
+// ----------------------------------------------------------------------------
+
+#define  SCANS          20000UL  // per run of the test
+#define  BYTE           360      // cycles, for 9 bits at 400 kHz
+#define  START_STOP     40       // cycles
+#define  TEENSY_COLUMN  100      // cycles
+#define  FOREIGN_BYTES  3        // in each transaction that isn't ours
+
+// registers used (see "../keyboard/ergodox/controller/mcp23018.c")
+#define  GPIOA  0x12
+#define  GPIOB  0x13
+
+// ----------------------------------------------------------------------------
+
+volatile uint8_t TWSR, TWBR, TWCR, TWDR;
+
+static uint64_t _cycles;  // of the CPU
+
+// ----------------------------------------------------------------------------
+// the expander (with IOCON.SEQOP = 1, so the register pointer toggles within
+// a pair)
+// ----------------------------------------------------------------------------
+
+static uint8_t _registers[0x16];
+static uint8_t _pointer;
+static uint8_t _keys[7];  // for each column, a bit (5-row) for each row down
+
+static void _device_write(uint8_t data) {
+	if (_pointer == GPIOA)
+		_registers[GPIOA] = data;  // (only the column drive is modelled)
+	_pointer ^= 1;
+}
+
+static uint8_t _device_read(void) {
+	uint8_t data = 0xFF;
+	if (_pointer == GPIOB)
+		for (uint8_t col=0; col<=6; col++)
+			if (!( _registers[GPIOA] & (1<<col) ))
+				data &= ~_keys[col];
+	_pointer ^= 1;
+	return data;
+}
+
+// ----------------------------------------------------------------------------
+// the TWI library: blocking functions
+// ----------------------------------------------------------------------------
+
+static bool _expect_address, _expect_pointer;
+
+uint8_t twi_start(void) {
+	_cycles += START_STOP;
+	_expect_address = true;
+	return 0;
+}
+
+void twi_stop(void) {
+	_cycles += START_STOP;
+}
+
+uint8_t twi_send(uint8_t data) {
+	_cycles += BYTE;
+	if (_expect_address) {
+		_expect_address = false;
+		_expect_pointer = !(data & 1);
+		return (data >> 1) == MCP23018_TWI_ADDRESS ? 0 : TW_MT_SLA_NACK;
+	}
+	if (_expect_pointer) {
+		_expect_pointer = false;
+		_pointer = data;
+	} else {
+		_device_write(data);
+	}
+	return 0;
+}
+
+uint8_t twi_read(uint8_t * data) {
+	_cycles += BYTE;
+	*data = _device_read();
+	return 0;
+}
+
+uint8_t twi_read_last(uint8_t * data) {
+	return twi_read(data);
+}
+
+// ----------------------------------------------------------------------------
+// the TWI library: asynchronous functions
+// - Transactions are done on the expander when they're queued (they're done
+//   in order, and the bus is ours alone, so this is the same), and finish
+//   when the CPU's cycle count passes their end time.
+// ----------------------------------------------------------------------------
+
+static uint64_t _finish[TWI_QUEUE_SIZE];  // end times of queued transactions
+static uint64_t _bus_free;                // end time of the last one
+
+static uint8_t _pending(void) {
+	uint8_t count = 0;
+	for (uint8_t i=0; i<TWI_QUEUE_SIZE; i++)
+		if (_finish[i] > _cycles)
+			count++;
+	return count;
+}
+
+static bool _add(uint8_t bytes) {
+	for (uint8_t i=0; i<TWI_QUEUE_SIZE; i++)
+		if (_finish[i] <= _cycles) {
+			if (_bus_free < _cycles)
+				_bus_free = _cycles;
+			_bus_free += 2*START_STOP + bytes*BYTE;
+			_finish[i] = _bus_free;
+			return true;
+		}
+	return false;
+}
+
+uint8_t twi_queue(struct twi_transaction * t) {
+	if (!_add( 1 + t->write_length + (t->read_length ? 1 : 0)
+	           + t->read_length ))
+		return 1;
+
+	uint64_t cycles = _cycles;  // (the bytes are on the bus in the background)
+	twi_start();
+	twi_send((t->address<<1) | TW_WRITE);
+	for (uint8_t i=0; i<t->write_length; i++)
+		twi_send(t->write_data[i]);
+	if (t->read_length) {
+		twi_start();
+		twi_send((t->address<<1) | TW_READ);
+		for (uint8_t i=0; i<t->read_length; i++)
+			twi_read(&t->read_data[i]);
+	}
+	_cycles = cycles;
+
+	t->status = TWI_PENDING;
+	return 0;
+}
+
+bool twi_busy(void) {
+	if (!_pending())
+		return false;
+	_cycles += 10;  // for the check
+	return true;
+}
+
+uint8_t twi_wait(struct twi_transaction * t) {
+	if (t->status == TWI_PENDING) {
+		if (_cycles < _bus_free)
+			_cycles = _bus_free;  // (ours is the last one queued)
+		t->status = 0;
+	}
+	return t->status;
+}
+
+/*
+ * Fill the queue with transactions that aren't ours
+ */
+static void _fill(void) {
+	while (_add(FOREIGN_BYTES));
+}
+
+// ----------------------------------------------------------------------------
+
+/*
+ * Do one pipelined scan, like `kb_update_matrix()`, and check it
+ *
+ * Returns
+ * - the number of keys read wrong
+ */
+static unsigned _scan(bool fill) {
+	uint16_t matrix[KB_ROWS] = {0};
+
+	for (uint8_t col=0; col<=6; col++)
+		_keys[col] = test_random() & test_random() & 0x3F;
+
+	bool responding = !mcp23018_update_matrix_begin(matrix);
+	for (uint8_t col=0; col<=6; col++) {
+		if (fill)
+			_fill();
+		if (responding)
+			mcp23018_update_column_queue(col);
+		_cycles += TEENSY_COLUMN;
+		if (responding)
+			responding = !mcp23018_update_column_finish(matrix, col);
+	}
+	if (responding)
+		responding = !mcp23018_update_matrix_end();
+	TEST_CHECK(responding, "the expander stopped responding");
+
+	unsigned wrong = 0;
+	for (uint8_t row=0; row<=5; row++)
+		for (uint8_t col=0; col<=6; col++)
+			if ( (bool)(matrix[row] & (1<<col))
+			     != (bool)(_keys[col] & (1<<(5-row))) )
+				wrong++;
+	return wrong;
+}
+
+static void _test(bool fill) {
+	unsigned wrong = 0;
+
+	_scan(fill);  // (initializes the expander)
+
+	uint64_t start = _cycles;
+	for (uint32_t scan=0; scan<SCANS; scan++) {
+		wrong += _scan(fill);
+		// let the bus go idle between scans
+		if (_cycles < _bus_free)
+			_cycles = _bus_free;
+	}
+
+	TEST_CHECK( !wrong, "queue %s: %u keys read wrong",
+	            fill ? "full" : "empty", wrong );
+	printf( "mcp23018: queue %-5s: %6.1f us per scan (modelled)\n",
+	        fill ? "full" : "empty",
+	        (double) (_cycles - start) / SCANS / (F_CPU / 1000000) );
+}
+
+// ----------------------------------------------------------------------------
+
+int main(void) {
+	_test(false);
+	_test(true);
+
+	TEST_EXIT("mcp23018");
+}
+
@@ -0,0 +1,302 @@
+/* ----------------------------------------------------------------------------
+ * Host tests : modifier keys
+ *
+ * Check `_kbfun_press_release()` and `_kbfun_is_pressed()` (in
+ * "../lib/key-functions/private.c"), which treat the modifiers as bits
+ * 0xE0..0xE7 of the key bitmap, against a simple model, with a long random
+ * sequence of presses and releases (of modifiers, and of other keys).  Then
+ * time them against the 8 case switches they replaced (kept here, as they
+ * were, for comparison).
+ *
+ * Also check that `kbfun_2_keys_capslock_press_release()` (in
+ * "../lib/key-functions/public/special.c") sends capslock without shift, when
+ * both of its keys are assigned to a shift (so that shift is held twice).
+ *
+ * The times are from the host, not the ATmega32U4, so only the comparison
+ * means anything.  gcc may compile the old switches to a jump table on the
+ * host; avr-gcc compiles switches this small to a chain of compares, so the
+ * host numbers favour the old code, if anything.
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2026 agent <agent@local>
+ * Released under The MIT License (MIT) (see "license.md")
+ * Project located at <https://github.com/benblazak/ergodox-firmware>
+ * ------------------------------------------------------------------------- */
+
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "../lib-other/pjrc/usb_keyboard/usb_keyboard.h"
+#include "../lib/usb/usage-page/keyboard.h"
+#include "../lib/key-functions/public.h"
+#include "../lib/key-functions/private.h"
+#include "../main.h"
+#include "./test.h"
+
+// ----------------------------------------------------------------------------
+
+#define  OPERATIONS  1000000UL  // in the random sequence
+#define  EVENTS      4096       // in each timed sequence (a power of 2)
+#define  REPEATS     500        // of each timed sequence
+
+// ----------------------------------------------------------------------------
+
+uint8_t keyboard_key_bitmap[KEYBOARD_KEY_BITMAP_SIZE];
+
+uint8_t main_arg_keycode;
+bool    main_arg_is_pressed;
+
+static uint8_t _sent[8][KEYBOARD_KEY_BITMAP_SIZE];  // reports "sent"
+static uint8_t _sent_count;
+
+int8_t usb_keyboard_send(void) {
+	if (_sent_count < 8)
+		memcpy(_sent[_sent_count++], keyboard_key_bitmap,
+		       KEYBOARD_KEY_BITMAP_SIZE);
+	return 0;
+}
+
+// ----------------------------------------------------------------------------
+// the old functions (modifiers in a separate byte, found with a switch)
+// ----------------------------------------------------------------------------
+
+static uint8_t old_modifier_keys;
+static uint8_t old_key_bitmap[KEYBOARD_KEY_BITMAP_SIZE];
+static uint8_t old_press_counts[256/2];
+
+__attribute__((noinline))
+static void old_press_release(bool press, uint8_t keycode) {
+	// no-op
+	if (keycode == 0)
+		return;
+
+	// modifier keys
+	switch (keycode) {
+		case KEY_LeftControl:  (press)
+				       ? (old_modifier_keys |=  (1<<0))
+				       : (old_modifier_keys &= ~(1<<0));
+				       return;
+		case KEY_LeftShift:    (press)
+				       ? (old_modifier_keys |=  (1<<1))
+				       : (old_modifier_keys &= ~(1<<1));
+				       return;
+		case KEY_LeftAlt:      (press)
+				       ? (old_modifier_keys |=  (1<<2))
+				       : (old_modifier_keys &= ~(1<<2));
+				       return;
+		case KEY_LeftGUI:      (press)
+				       ? (old_modifier_keys |=  (1<<3))
+				       : (old_modifier_keys &= ~(1<<3));
+				       return;
+		case KEY_RightControl: (press)
+				       ? (old_modifier_keys |=  (1<<4))
+				       : (old_modifier_keys &= ~(1<<4));
+				       return;
+		case KEY_RightShift:   (press)
+				       ? (old_modifier_keys |=  (1<<5))
+				       : (old_modifier_keys &= ~(1<<5));
+				       return;
+		case KEY_RightAlt:     (press)
+				       ? (old_modifier_keys |=  (1<<6))
+				       : (old_modifier_keys &= ~(1<<6));
+				       return;
+		case KEY_RightGUI:     (press)
+				       ? (old_modifier_keys |=  (1<<7))
+				       : (old_modifier_keys &= ~(1<<7));
+				       return;
+	}
+
+	// all others
+	uint8_t * counts = &old_press_counts[keycode>>1];
+	uint8_t   shift  = (keycode & 1) ? 4 : 0;
+	uint8_t   count  = (*counts >> shift) & 0x0F;
+
+	if (press) {
+		if (count < 0x0F)
+			count++;
+	} else {
+		if (count)
+			count--;
+	}
+
+	*counts = (*counts & ~(0x0F<<shift)) | (count<<shift);
+
+	(count)
+	? (old_key_bitmap[keycode>>3] |=  (1<<(keycode&7)))
+	: (old_key_bitmap[keycode>>3] &= ~(1<<(keycode&7)));
+}
+
+// (with the fall-through between cases that it had)
+__attribute__((noinline))
+static bool old_is_pressed(uint8_t keycode) {
+	// modifier keys
+	switch (keycode) {
+		case KEY_LeftControl:  if (old_modifier_keys & (1<<0))
+					       return true;
+		case KEY_LeftShift:    if (old_modifier_keys & (1<<1))
+					       return true;
+		case KEY_LeftAlt:      if (old_modifier_keys & (1<<2))
+					       return true;
+		case KEY_LeftGUI:      if (old_modifier_keys & (1<<3))
+					       return true;
+		case KEY_RightControl: if (old_modifier_keys & (1<<4))
+					       return true;
+		case KEY_RightShift:   if (old_modifier_keys & (1<<5))
+					       return true;
+		case KEY_RightAlt:     if (old_modifier_keys & (1<<6))
+					       return true;
+		case KEY_RightGUI:     if (old_modifier_keys & (1<<7))
+					       return true;
+	}
+
+	// all others
+	return old_key_bitmap[keycode>>3] & (1<<(keycode&7));
+}
+
+// ----------------------------------------------------------------------------
+
+static uint8_t _model[256];  // how many keys are holding down each keycode
+
+static uint8_t _random_keycode(void) {
+	// half modifiers, half others (including 0, the no-op)
+	return (test_random() & 1) ? KEY_LeftControl + test_random() % 8
+	                           : test_random() % KEY_LeftControl;
+}
+
+static void _test_random(void) {
+	for (uint32_t i = 0; i < OPERATIONS; i++) {
+		uint8_t keycode = _random_keycode();
+		// (more presses than releases while few are down, so counts build
+		// up past 1, and sometimes to the limit)
+		bool press = test_random() % 4 < (_model[keycode] < 15 ? 2 : 1);
+
+		_kbfun_press_release(press, keycode);
+		if (keycode) {
+			if (press && _model[keycode] < 15)
+				_model[keycode]++;
+			else if (!press && _model[keycode])
+				_model[keycode]--;
+		}
+
+		TEST_CHECK( _kbfun_is_pressed(keycode) == (_model[keycode] > 0),
+		            "operation %lu: keycode 0x%02X: pressed is %d, held %u "
+		            "times", (unsigned long) i, keycode,
+		            _kbfun_is_pressed(keycode), _model[keycode] );
+
+		uint8_t modifiers = 0;
+		for (uint8_t bit = 0; bit < 8; bit++)
+			if (_model[KEY_LeftControl + bit])
+				modifiers |= 1<<bit;
+		TEST_CHECK( keyboard_modifier_keys == modifiers,
+		            "operation %lu: modifier byte 0x%02X, expected 0x%02X",
+		            (unsigned long) i, keyboard_modifier_keys, modifiers );
+
+		if (test_failures > 10)
+			return;
+	}
+
+	// release everything
+	for (uint16_t keycode = 1; keycode < 256; keycode++)
+		for (; _model[keycode]; _model[keycode]--)
+			_kbfun_press_release(false, keycode);
+	for (uint8_t i = 0; i < KEYBOARD_KEY_BITMAP_SIZE; i++)
+		TEST_CHECK(!keyboard_key_bitmap[i], "keys left pressed");
+}
+
+// ----------------------------------------------------------------------------
+
+static bool _sent_pressed(uint8_t report, uint8_t keycode) {
+	return _sent[report][keycode>>3] & (1<<(keycode&7));
+}
+
+static void _capslock_key(bool press, uint8_t keycode) {
+	main_arg_keycode = keycode;
+	main_arg_is_pressed = press;
+	kbfun_2_keys_capslock_press_release();
+}
+
+static void _test_capslock(void) {
+	// both keys on left shift, so it's held twice when capslock is sent
+	_capslock_key(true, KEY_LeftShift);
+	_capslock_key(true, KEY_LeftShift);
+
+	TEST_CHECK(_sent_count == 2, "capslock: %u reports sent", _sent_count);
+	TEST_CHECK( _sent_pressed(0, KEY_CapsLock)
+	            && !_sent_pressed(0, KEY_LeftShift),
+	            "capslock: not sent alone" );
+	TEST_CHECK( !_sent_pressed(1, KEY_CapsLock)
+	            && !_sent_pressed(1, KEY_LeftShift),
+	            "capslock: not released alone" );
+	TEST_CHECK( _kbfun_is_pressed(KEY_LeftShift),
+	            "capslock: shift not restored" );
+
+	// shift stays down until both keys are up
+	_capslock_key(false, KEY_LeftShift);
+	TEST_CHECK( _kbfun_is_pressed(KEY_LeftShift),
+	            "capslock: shift released with a key still down" );
+	_capslock_key(false, KEY_LeftShift);
+	TEST_CHECK( !_kbfun_is_pressed(KEY_LeftShift),
+	            "capslock: shift left pressed" );
+}
+
+// ----------------------------------------------------------------------------
+
+static double _now(void) {
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+static uint8_t _keycodes[EVENTS];
+
+/*
+ * Time a press, `is_pressed()` on the same keycode, and a release, for each
+ * keycode in `_keycodes`
+ */
+#define BENCHMARK(press_release, is_pressed, result) \
+	do { \
+		volatile uint8_t sink = 0; \
+		double start = _now(); \
+		for (uint32_t r = 0; r < REPEATS; r++) \
+			for (uint16_t e = 0; e < EVENTS; e++) { \
+				press_release(true, _keycodes[e]); \
+				sink += is_pressed(_keycodes[e]); \
+				press_release(false, _keycodes[e]); \
+			} \
+		(result) = (_now() - start) / REPEATS / EVENTS; \
+		(void) sink; \
+	} while (0)
+
+static void _benchmark(void) {
+	printf("modifiers: ns per press + is_pressed + release\n");
+	printf("    keys           switch   bitmap\n");
+
+	const char * names[] = { "modifiers", "others", "mixed" };
+
+	for (uint8_t kind = 0; kind < 3; kind++) {
+		for (uint16_t e = 0; e < EVENTS; e++)
+			_keycodes[e] =
+				(kind == 0) ? KEY_LeftControl + test_random() % 8
+				: (kind == 1) ? 1 + test_random() % (KEY_LeftControl-1)
+				: _random_keycode();
+
+		double old, new;
+		BENCHMARK(old_press_release, old_is_pressed, old);
+		BENCHMARK(_kbfun_press_release, _kbfun_is_pressed, new);
+		printf("    %-12s %8.2f %8.2f\n", names[kind], old, new);
+	}
+}
+
+// ----------------------------------------------------------------------------
+
+int main(void) {
+	_test_random();
+	_test_capslock();
+	_benchmark();
+
+	printf("modifiers: %lu random operations\n", OPERATIONS);
+	TEST_EXIT("modifiers");
+}
+
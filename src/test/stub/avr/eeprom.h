@@ -0,0 +1,31 @@
+/* ----------------------------------------------------------------------------
+ * Host tests : stub for <avr/eeprom.h>
+ *
+ * Just enough for the firmware's sources to compile on the host.  Tests that
+ * use the EEPROM define these functions.
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2026 agent <agent@local>
+ * Released under The MIT License (MIT) (see "license.md")
+ * Project located at <https://github.com/benblazak/ergodox-firmware>
+ * ------------------------------------------------------------------------- */
+
+
+#ifndef TEST__STUB__AVR__EEPROM_h
+	#define TEST__STUB__AVR__EEPROM_h
+
+	#include <stdint.h>
+
+	// (a section of its own, so tests can find it: it's from
+	// `__start_eeprom` to `__stop_eeprom`)
+	#define EEMEM  __attribute__((section("eeprom")))
+
+	uint8_t  eeprom_read_byte    (const uint8_t * address);
+	uint16_t eeprom_read_word    (const uint16_t * address);
+	void     eeprom_read_block   (void * dst, const void * src, unsigned n);
+	void     eeprom_update_byte  (uint8_t * address, uint8_t value);
+	void     eeprom_update_word  (uint16_t * address, uint16_t value);
+	void     eeprom_update_block (const void * src, void * dst, unsigned n);
+	uint8_t  eeprom_is_ready     (void);
+
+#endif
+
@@ -0,0 +1,22 @@
+/* ----------------------------------------------------------------------------
+ * Host tests : stub for <avr/interrupt.h>
+ *
+ * Just enough for the firmware's sources to compile on the host.
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2026 agent <agent@local>
+ * Released under The MIT License (MIT) (see "license.md")
+ * Project located at <https://github.com/benblazak/ergodox-firmware>
+ * ------------------------------------------------------------------------- */
+
+
+#ifndef TEST__STUB__AVR__INTERRUPT_h
+	#define TEST__STUB__AVR__INTERRUPT_h
+
+	#include <avr/io.h>
+
+	#define ISR(vector)  void vector(void); void vector(void)
+	#define sei()
+	#define cli()
+
+#endif
+
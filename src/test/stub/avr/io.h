@@ -0,0 +1,86 @@
+/* ----------------------------------------------------------------------------
+ * Host tests : stub for <avr/io.h>
+ *
+ * Just enough for the firmware's sources to compile on the host.  Registers are plain
+ * variables (declared here, and defined by tests that use them).
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2026 agent <agent@local>
+ * Released under The MIT License (MIT) (see "license.md")
+ * Project located at <https://github.com/benblazak/ergodox-firmware>
+ * ------------------------------------------------------------------------- */
+
+
+#ifndef TEST__STUB__AVR__IO_h
+	#define TEST__STUB__AVR__IO_h
+
+	#include <stdint.h>
+
+	#define  __AVR_ATmega32U4__  1
+
+	#define  R8(name)   extern volatile uint8_t  name;
+	#define  R16(name)  extern volatile uint16_t name;
+
+	R8(PORTB) R8(PORTC) R8(PORTD) R8(PORTE) R8(PORTF)
+	R8(DDRB)  R8(DDRC)  R8(DDRD)  R8(DDRE)  R8(DDRF)
+	R8(PINB)  R8(PINC)  R8(PIND)  R8(PINE)  R8(PINF)
+
+	R8(CLKPR) R8(SREG) R8(SMCR) R8(EIMSK) R8(PCICR) R8(SPCR) R8(ACSR)
+	R8(EECR) R8(ADCSRA) R8(UCSR1B)
+
+	R8(TCCR0A) R8(TCCR0B) R8(OCR0A) R8(OCR0B) R8(TIMSK0) R8(TCNT0) R8(TIFR0)
+	R8(TCCR1A) R8(TCCR1B) R16(OCR1A) R16(OCR1B) R16(OCR1C) R8(TIMSK1)
+	R8(TCCR3A) R8(TCCR3B) R16(OCR3A) R8(TIMSK3) R16(TCNT3) R8(TIFR3)
+	R8(TIMSK4)
+
+	R8(TWSR) R8(TWBR) R8(TWCR) R8(TWDR)
+
+	R8(UDCON) R8(USBCON) R8(UENUM) R8(UEINTX) R8(UEDATX) R8(UDFNUML)
+	R8(UDINT) R8(UDIEN) R8(UECONX) R8(UECFG0X) R8(UECFG1X) R8(UEIENX)
+	R8(UDADDR) R8(UERST) R8(PLLCSR) R8(UHWCON) R8(UEBCLX)
+
+	#undef R8
+	#undef R16
+
+	// bits
+	#define  SE        0
+	#define  TWIE      0
+	#define  TWEN      2
+	#define  TWSTO     4
+	#define  TWSTA     5
+	#define  TWEA      6
+	#define  TWINT     7
+	#define  TWPS0     0
+	#define  TWPS1     1
+	#define  CS00      0
+	#define  CS01      1
+	#define  CS02      2
+	#define  WGM01     1
+	#define  OCIE0A    1
+	#define  OCF0A     1
+	#define  CS30      0
+	#define  CS31      1
+	#define  WGM32     3
+	#define  OCIE3A    1
+	#define  OCF3A     1
+	#define  EPEN      0
+	#define  PLOCK     0
+	#define  TXINI     0
+	#define  RXOUTI    2
+	#define  SOFI      2
+	#define  SOFE      2
+	#define  EORSTI    3
+	#define  EORSTE    3
+	#define  RXSTPI    3
+	#define  RXSTPE    3
+	#define  RSTDT     3
+	#define  OTGPADE   4
+	#define  STALLRQC  4
+	#define  FRZCLK    5
+	#define  RWAL      5
+	#define  STALLRQ   5
+	#define  ADDEN     7
+	#define  FIFOCON   7
+	#define  USBE      7
+
+#endif
+
@@ -0,0 +1,24 @@
+/* ----------------------------------------------------------------------------
+ * Host tests : stub for <avr/pgmspace.h>
+ *
+ * Just enough for the firmware's sources to compile on the host.  Flash is just
+ * memory.
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2026 agent <agent@local>
+ * Released under The MIT License (MIT) (see "license.md")
+ * Project located at <https://github.com/benblazak/ergodox-firmware>
+ * ------------------------------------------------------------------------- */
+
+
+#ifndef TEST__STUB__AVR__PGMSPACE_h
+	#define TEST__STUB__AVR__PGMSPACE_h
+
+	#include <stdint.h>
+
+	#define PROGMEM
+	#define pgm_read_byte(address)  ( *(const uint8_t *) (address) )
+	#define pgm_read_word(address)  ( *(const uint16_t *) (address) )
+	#define pgm_read_ptr(address)   ( *(void * const *) (address) )
+
+#endif
+
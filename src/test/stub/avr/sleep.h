@@ -0,0 +1,24 @@
+/* ----------------------------------------------------------------------------
+ * Host tests : stub for <avr/sleep.h>
+ *
+ * Just enough for the firmware's sources to compile on the host.
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2026 agent <agent@local>
+ * Released under The MIT License (MIT) (see "license.md")
+ * Project located at <https://github.com/benblazak/ergodox-firmware>
+ * ------------------------------------------------------------------------- */
+
+
+#ifndef TEST__STUB__AVR__SLEEP_h
+	#define TEST__STUB__AVR__SLEEP_h
+
+	#define SLEEP_MODE_IDLE  0
+
+	#define set_sleep_mode(mode)
+	#define sleep_mode()
+	#define sleep_enable()
+	#define sleep_disable()
+	#define sleep_cpu()
+
+#endif
+
@@ -0,0 +1,21 @@
+/* ----------------------------------------------------------------------------
+ * Host tests : stub for <util/atomic.h>
+ *
+ * Just enough for the firmware's sources to compile on the host.
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2026 agent <agent@local>
+ * Released under The MIT License (MIT) (see "license.md")
+ * Project located at <https://github.com/benblazak/ergodox-firmware>
+ * ------------------------------------------------------------------------- */
+
+
+#ifndef TEST__STUB__UTIL__ATOMIC_h
+	#define TEST__STUB__UTIL__ATOMIC_h
+
+	#define ATOMIC_RESTORESTATE  0
+	#define ATOMIC_FORCEON       0
+
+	#define ATOMIC_BLOCK(type)  for (int _atomic = 1; _atomic; _atomic = 0)
+
+#endif
+
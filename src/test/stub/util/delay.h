@@ -0,0 +1,22 @@
+/* ----------------------------------------------------------------------------
+ * Host tests : stub for <util/delay.h>
+ *
+ * Just enough for the firmware's sources to compile on the host.  Delays take no
+ * time.
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2026 agent <agent@local>
+ * Released under The MIT License (MIT) (see "license.md")
+ * Project located at <https://github.com/benblazak/ergodox-firmware>
+ * ------------------------------------------------------------------------- */
+
+
+#ifndef TEST__STUB__UTIL__DELAY_h
+	#define TEST__STUB__UTIL__DELAY_h
+
+	#define _delay_ms(ms)  ( (void) (ms) )
+	#define _delay_us(us)  ( (void) (us) )
+
+	#define __builtin_avr_delay_cycles(cycles)  ( (void) (cycles) )
+
+#endif
+
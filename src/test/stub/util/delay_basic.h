@@ -0,0 +1,20 @@
+/* ----------------------------------------------------------------------------
+ * Host tests : stub for <util/delay_basic.h>
+ *
+ * Just enough for the firmware's sources to compile on the host.
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2026 agent <agent@local>
+ * Released under The MIT License (MIT) (see "license.md")
+ * Project located at <https://github.com/benblazak/ergodox-firmware>
+ * ------------------------------------------------------------------------- */
+
+
+#ifndef TEST__STUB__UTIL__DELAY_BASIC_h
+	#define TEST__STUB__UTIL__DELAY_BASIC_h
+
+	#include <stdint.h>
+
+	void _delay_loop_1(uint8_t count);
+
+#endif
+
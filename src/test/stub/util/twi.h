@@ -0,0 +1,37 @@
+/* ----------------------------------------------------------------------------
+ * Host tests : stub for <util/twi.h>
+ *
+ * Just enough for the firmware's sources to compile on the host.
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2026 agent <agent@local>
+ * Released under The MIT License (MIT) (see "license.md")
+ * Project located at <https://github.com/benblazak/ergodox-firmware>
+ * ------------------------------------------------------------------------- */
+
+
+#ifndef TEST__STUB__UTIL__TWI_h
+	#define TEST__STUB__UTIL__TWI_h
+
+	#include <avr/io.h>
+
+	#define  TW_STATUS        (TWSR & 0xF8)
+
+	#define  TW_START         0x08
+	#define  TW_REP_START     0x10
+	#define  TW_MT_SLA_ACK    0x18
+	#define  TW_MT_SLA_NACK   0x20
+	#define  TW_MT_DATA_ACK   0x28
+	#define  TW_MT_DATA_NACK  0x30
+	#define  TW_MT_ARB_LOST   0x38
+	#define  TW_MR_SLA_ACK    0x40
+	#define  TW_MR_SLA_NACK   0x48
+	#define  TW_MR_DATA_ACK   0x50
+	#define  TW_MR_DATA_NACK  0x58
+	#define  TW_NO_INFO       0xF8
+	#define  TW_BUS_ERROR     0x00
+
+	#define  TW_WRITE         0
+	#define  TW_READ          1
+
+#endif
+
@@ -0,0 +1,67 @@
+/* ----------------------------------------------------------------------------
+ * Host tests : common
+ *
+ * The tests in this directory are built with the host's compiler (not
+ * avr-gcc), and run on the host; see "makefile".  Each one is a program that
+ * prints what it checked, and exits with a nonzero status if anything failed.
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2026 agent <agent@local>
+ * Released under The MIT License (MIT) (see "license.md")
+ * Project located at <https://github.com/benblazak/ergodox-firmware>
+ * ------------------------------------------------------------------------- */
+
+
+#ifndef TEST__TEST_h
+	#define TEST__TEST_h
+
+	#include <stdint.h>
+	#include <stdio.h>
+
+	// --------------------------------------------------------------------
+
+	static unsigned test_failures;
+
+	/*
+	 * TEST_CHECK()
+	 * - Print a message (like `printf()`) and count a failure, if
+	 *   'condition' is false
+	 */
+	#define TEST_CHECK(condition, ...) \
+		do { \
+			if (!(condition)) { \
+				printf("FAILED: " __VA_ARGS__); \
+				printf("\n"); \
+				test_failures++; \
+			} \
+		} while (0)
+
+	/*
+	 * TEST_EXIT()
+	 * - Print the result, and return the exit status, from `main()`
+	 */
+	#define TEST_EXIT(name) \
+		do { \
+			printf( "%s: %s\n", (name), \
+			        test_failures ? "FAILED" : "ok" ); \
+			return test_failures ? 1 : 0; \
+		} while (0)
+
+	// --------------------------------------------------------------------
+
+	/*
+	 * test_random()
+	 * - A small repeatable pseudo-random number generator (xorshift), so
+	 *   runs don't depend on the host's `rand()`
+	 */
+	static uint32_t test_random_state = 2463534242UL;
+
+	static inline uint32_t test_random(void) {
+		uint32_t x = test_random_state;
+		x ^= x << 13;
+		x ^= x >> 17;
+		x ^= x << 5;
+		return test_random_state = x;
+	}
+
+#endif
+
@@ -0,0 +1,204 @@
+/* ----------------------------------------------------------------------------
+ * Host tests : timer wheel
+ *
+ * Start, stop, and run a set of timers at random, with the clock (a stand-in
+ * for `time_ms()`) jumping ahead by a random amount between runs, as if the
+ * main loop were falling behind.  Each timer's due times are tracked here, and
+ * every time one fires it's checked that
+ * - it was armed, and due (at or before the current time)
+ * - it's firing for the next period it should (none are skipped, and
+ *   periodic timers don't drift)
+ * - within a run, timers fire in order of when they were due, and timers due
+ *   at the same time fire in the order they were (re)started
+ * and after every run, that no armed timer is overdue.
+ *
+ * This is done twice: starting near 0, and starting shortly before the
+ * millisecond count wraps around.
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2026 agent <agent@local>
+ * Released under The MIT License (MIT) (see "license.md")
+ * Project located at <https://github.com/benblazak/ergodox-firmware>
+ * ------------------------------------------------------------------------- */
+
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "../lib/time.h"
+#include "../lib/timer-wheel.h"
+#include "./test.h"
+
+// ----------------------------------------------------------------------------
+
+#define  TIMERS  16
+#define  STEPS   200000UL  // per run of the test
+
+// ----------------------------------------------------------------------------
+
+static uint32_t _ms;  // what `time_ms()` returns
+
+uint32_t time_ms(void) { return _ms; }
+
+// ----------------------------------------------------------------------------
+
+static struct timer _timers[TIMERS];
+
+static struct {
+	bool     armed;
+	uint32_t due;     // the next time it should fire
+	uint16_t period;
+	uint32_t order;   // when it was last (re)started, or rescheduled
+} _expected[TIMERS];
+
+static uint32_t _order;  // incremented for each start, and reschedule
+
+static uint32_t _last_due;    // of the last timer to fire, in this run
+static uint32_t _last_order;  // (and its order)
+static bool     _in_run;      // whether anything's fired yet, in this run
+
+static unsigned long _fired;
+
+/*
+ * Has 'a' come before 'b' (allowing for the time wrapping around)?
+ */
+static bool _before(uint32_t a, uint32_t b) {
+	return (int32_t)(a - b) < 0;
+}
+
+static void _fire(uint8_t i) {
+	_fired++;
+
+	TEST_CHECK(_expected[i].armed, "timer %u fired while stopped", i);
+	TEST_CHECK( !_before(_ms, _expected[i].due),
+	            "timer %u fired early (due %lu, now %lu)", i,
+	            (unsigned long) _expected[i].due, (unsigned long) _ms );
+
+	if (_in_run) {
+		bool in_order = _before(_last_due, _expected[i].due)
+		                || ( _last_due == _expected[i].due
+		                     && _last_order < _expected[i].order );
+		TEST_CHECK( in_order, "timer %u (due %lu) fired out of order", i,
+		            (unsigned long) _expected[i].due );
+	}
+	_in_run     = true;
+	_last_due   = _expected[i].due;
+	_last_order = _expected[i].order;
+
+	if (_expected[i].period) {
+		_expected[i].due  += _expected[i].period;
+		_expected[i].order = ++_order;
+	} else {
+		_expected[i].armed = false;
+	}
+}
+
+#define  F(i)  static void _fire_##i(void) { _fire(i); }
+F(0) F(1) F(2)  F(3)  F(4)  F(5)  F(6)  F(7)
+F(8) F(9) F(10) F(11) F(12) F(13) F(14) F(15)
+#undef F
+
+static const void_funptr_t _functions[TIMERS] = {
+	&_fire_0, &_fire_1, &_fire_2,  &_fire_3,
+	&_fire_4, &_fire_5, &_fire_6,  &_fire_7,
+	&_fire_8, &_fire_9, &_fire_10, &_fire_11,
+	&_fire_12, &_fire_13, &_fire_14, &_fire_15,
+};
+
+// ----------------------------------------------------------------------------
+
+static void _start(uint8_t i, uint16_t delay, uint16_t period) {
+	timer_wheel_start(&_timers[i], delay, period, _functions[i]);
+
+	// (the clock doesn't move between runs and starts here, so a delay of
+	// 0 is always the next millisecond)
+	_expected[i].armed  = true;
+	_expected[i].due    = _ms + (delay ? delay : 1);
+	_expected[i].period = period;
+	_expected[i].order  = ++_order;
+}
+
+static void _stop(uint8_t i) {
+	timer_wheel_stop(&_timers[i]);
+	_expected[i].armed = false;
+}
+
+static void _run(void) {
+	_in_run = false;
+	timer_wheel_run();
+
+	for (uint8_t i = 0; i < TIMERS; i++) {
+		TEST_CHECK( timer_wheel_is_armed(&_timers[i]) == _expected[i].armed,
+		            "timer %u: armed is %d, expected %d", i,
+		            timer_wheel_is_armed(&_timers[i]), _expected[i].armed );
+		TEST_CHECK( !_expected[i].armed || _before(_ms, _expected[i].due),
+		            "timer %u overdue (due %lu, now %lu)", i,
+		            (unsigned long) _expected[i].due, (unsigned long) _ms );
+	}
+}
+
+// ----------------------------------------------------------------------------
+
+static void _test_random(uint32_t start) {
+	_ms = start;
+
+	for (uint32_t step = 0; step < STEPS; step++) {
+		uint8_t i = test_random() % TIMERS;
+
+		switch (test_random() % 8) {
+			case 0:
+				// (periods that are, and aren't, multiples of the number
+				// of slots)
+				_start( i, test_random() % 200,
+				        (test_random() & 1) ? 0 : 1 + test_random() % 60 );
+				break;
+			case 1:
+				_stop(i);
+				break;
+			default:
+				// usually one millisecond, sometimes more
+				_ms += (test_random() % 4) ? 1 : test_random() % 40;
+				_run();
+				break;
+		}
+	}
+
+	for (uint8_t i = 0; i < TIMERS; i++)
+		_stop(i);
+}
+
+// a timer that restarts itself, with no delay, from its own function
+static struct timer _self;
+static unsigned     _self_count;
+static uint32_t     _self_last;
+
+static void _self_function(void) {
+	TEST_CHECK( !_self_count || _ms != _self_last,
+	            "restarted timer ran twice in the same millisecond" );
+	_self_last = _ms;
+	if (++_self_count < 3)
+		timer_wheel_start(&_self, 0, 0, &_self_function);
+}
+
+static void _test_restart(void) {
+	_ms = 50;
+	timer_wheel_start(&_self, 0, 0, &_self_function);
+	for (uint8_t i = 0; i < 5; i++) {
+		_ms++;
+		timer_wheel_run();
+	}
+	TEST_CHECK( _self_count == 3, "self restarting timer ran %u times "
+	            "(expected 3)", _self_count );
+}
+
+// ----------------------------------------------------------------------------
+
+int main(void) {
+	_test_random(0);
+	_test_random(UINT32_MAX - STEPS/2);  // wraps around early on
+	_test_restart();
+
+	printf( "timer wheel: %lu timer calls, %lu steps, wrapping at 0\n",
+	        _fired, 2 * STEPS );
+	TEST_EXIT("timer wheel");
+}
+